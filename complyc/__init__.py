@@ -0,0 +1,20 @@
+"""
+ComplyC – configurable coding-guideline compliance engine for C
+
+Library use: `from complyc import Analyzer` (see api.py). The API is
+imported on first access, so `python -m complyc.main` does not pay for it.
+"""
+
+__all__ = ["Analyzer", "Violation"]
+
+
+def __getattr__(name):
+    if name == "Analyzer":
+        from .api import Analyzer
+
+        return Analyzer
+    if name == "Violation":
+        from .rule_engine import Violation
+
+        return Violation
+    raise AttributeError(f"module 'complyc' has no attribute {name!r}")
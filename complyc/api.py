@@ -0,0 +1,111 @@
+"""
+api.py – In-process library API for ComplyC
+
+For tools that would otherwise run `python -m complyc.main` and parse its
+JSON report:
+
+    from complyc import Analyzer
+
+    analyzer = Analyzer("rules/complyc_style.yml")
+    for v in analyzer.analyze_source(text, "src/foo.c"):
+        print(v.file, v.line, v.rule_id, v.message)
+    for v in analyzer.analyze_files(["src/", "include/"]):
+        ...
+
+Violations are yielded lazily, file by file, as rule_engine.Violation
+objects. An Analyzer keeps its rules, the parser and (for files) a result
+memo keyed by mtime/size warm between calls, so repeated calls only pay for
+what changed. Nothing is printed: errors raise, and non-fatal problems (an
+unreadable directory, a rule check that failed) are logged as warnings of the
+"complyc" logger. Nothing is written either: no reports/ folder, no cache
+directory (unless cache_dir is given for the rule bundle).
+"""
+
+from __future__ import annotations
+
+import os
+import tempfile
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Sequence, Union
+
+from .discovery import iter_sources
+from .loader import load_rules
+from .metrics import FunctionMetrics
+from .rule_engine import Violation
+from .runner import ResultMemo, analyze_source, iter_analyze
+
+RulesArg = Union[str, "os.PathLike[str]", List[Dict[str, Any]]]
+
+
+class Analyzer:
+    """
+    rules     : path of a rules YAML file, or an already loaded rule list
+    use_gcc   : force (True) or disable (False) GCC preprocessing; None
+                follows the YAML 'preprocessor' style key (builtin if absent)
+    cache_dir : optional, lets a YAML path be loaded from a rule bundle
+    """
+
+    def __init__(self, rules: RulesArg, use_gcc: Optional[bool] = None, cache_dir: Optional[str] = None):
+        if isinstance(rules, (str, os.PathLike)):
+            style, self.rules = load_rules(os.fspath(rules), cache_dir=cache_dir)
+        else:
+            style, self.rules = {}, list(rules)
+        if use_gcc is None:
+            use_gcc = str((style or {}).get("preprocessor", "builtin")).lower() == "gcc"
+        self.use_gcc = use_gcc
+        self._memo = ResultMemo()
+
+    def analyze_source(
+        self,
+        text: str,
+        filename: str = "<buffer>",
+        metrics: Optional[List[FunctionMetrics]] = None,
+    ) -> Iterator[Violation]:
+        """
+        Violations of a source held in memory, reported against filename.
+
+        In GCC mode the text is preprocessed from a temporary copy, with the
+        directory of filename on the quoted-include path (-iquote), so
+        `#include "local.h"` resolves as it would for the file itself. Parse
+        errors propagate (pycparser's ParseError, parser.PreprocessError).
+        """
+        text = text.replace("\r\n", "\n").replace("\r", "\n")
+        if not self.use_gcc:
+            yield from analyze_source(filename, text, self.rules, False, metrics)
+            return
+
+        fd, tmp = tempfile.mkstemp(suffix=os.path.splitext(filename)[1] or ".c", prefix="complyc_api_")
+        quote_dirs = [os.path.dirname(os.path.abspath(filename))]
+        try:
+            with os.fdopen(fd, "w", encoding="utf-8") as f:
+                f.write(text)
+            violations = analyze_source(filename, text, self.rules, True, metrics,
+                                        gcc_path=tmp, quote_dirs=quote_dirs)
+        finally:
+            os.remove(tmp)
+        yield from violations
+
+    def analyze_files(
+        self,
+        paths: Iterable[str],
+        jobs: int = 1,
+        includes: Optional[Sequence[str]] = None,
+        excludes: Optional[Sequence[str]] = None,
+        metrics: Optional[List[FunctionMetrics]] = None,
+    ) -> Iterator[Violation]:
+        """
+        Violations of files, directories and glob patterns (expanded like on
+        the command line), file by file in discovery order.
+
+        jobs > 1 analyzes on worker processes (no result memo there).
+        """
+        sources = iter_sources(paths, includes=includes, excludes=excludes)
+        if jobs == 1:
+            for path in sources:
+                yield from self._memo.analyze(path, self.rules, self.use_gcc, metrics)
+            return
+        for _path, violations, file_metrics in iter_analyze(
+            sources, self.rules, self.use_gcc, jobs=jobs, want_metrics=metrics is not None
+        ):
+            if metrics is not None:
+                metrics.extend(file_metrics)
+            yield from violations
@@ -0,0 +1,141 @@
+"""
+buildgen.py – Generate ninja / make rules for per-file analysis
+
+`--emit-ninja build.ninja` (or `--emit-make complyc.mk`) writes one build
+action per discovered file instead of analyzing anything:
+
+    stamp  <stamp-dir>/<file>.json : <file> | rules YAML [+ include closure]
+    report <stamp-dir>/complyc_report.json : all stamps   (complyc merge)
+
+Each stamp is the single-file JSON report of a normal complyc run, so the
+build tool re-analyzes exactly the files whose inputs changed, runs them in
+parallel and keeps the stamps as its cache; the final action merges them,
+in discovery order, into one report.
+
+The include closure is only declared in GCC mode: the builtin preprocessor
+drops #include lines, so headers cannot change another file's result.
+
+Paths in the generated file are relative to its directory, which is where
+ninja/make must run. New or removed files need the file to be regenerated.
+"""
+
+from __future__ import annotations
+
+import os
+import shlex
+import sys
+from typing import Dict, List, Optional, Sequence
+
+from .includes import IncludeGraph
+
+DEFAULT_STAMP_DIR = ".complyc_build"
+REPORT_NAME = "complyc_report.json"
+
+
+def stamp_path(stamp_dir: str, src: str) -> str:
+    """<stamp_dir>/<src>.json, with absolute and ../ paths kept inside stamp_dir."""
+    rel = os.path.normpath(src).lstrip(os.sep)
+    parts = ["__" if part == ".." else part for part in rel.split(os.sep)]
+    return os.path.join(stamp_dir, *parts) + ".json"
+
+
+def include_deps(sources: Sequence[str]) -> Dict[str, List[str]]:
+    graph = IncludeGraph(None)
+    graph.build(sources)
+    return {src: sorted(graph.closure(src)) for src in sources}
+
+
+class _Plan:
+    """Everything both generators need, with paths relative to the build file."""
+
+    def __init__(
+        self,
+        build_file: str,
+        sources: Sequence[str],
+        rules_path: str,
+        use_gcc: bool,
+        cache_dir: Optional[str],
+        stamp_dir: str,
+        report: Optional[str],
+    ):
+        base = os.path.dirname(os.path.abspath(build_file))
+        rel = lambda p: os.path.relpath(os.path.abspath(p), base)
+
+        deps = include_deps(sources) if use_gcc else {}
+        self.rules = rel(rules_path)
+        self.report = rel(report) if report else os.path.join(rel(stamp_dir), REPORT_NAME)
+        self.units = [
+            (rel(src), rel(stamp_path(stamp_dir, src)), [rel(h) for h in deps.get(src, [])])
+            for src in sources
+        ]
+
+        # The package must be importable from the build directory
+        package_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        prefix = "" if package_root == base else f"PYTHONPATH={shlex.quote(package_root)} "
+        self.complyc = prefix + shlex.join([sys.executable, "-m", "complyc.main"])
+        flags = ["--rules", self.rules, "--use-gcc" if use_gcc else "--no-gcc",
+                 "--no-reports", "--quiet"]
+        if cache_dir:
+            flags += ["--cache-dir", rel(cache_dir)]
+        self.flags = shlex.join(flags)
+
+
+# ---------- ninja ----------
+
+def _ninja_escape(path: str) -> str:
+    return path.replace("$", "$$").replace(" ", "$ ").replace(":", "$:")
+
+
+def write_ninja(build_file: str, sources, rules_path, use_gcc, cache_dir, stamp_dir, report=None) -> int:
+    plan = _Plan(build_file, sources, rules_path, use_gcc, cache_dir, stamp_dir, report)
+    e = _ninja_escape
+    with open(build_file, "w", encoding="utf-8") as f:
+        f.write("# Generated by complyc --emit-ninja; regenerate when files are added or removed\n\n")
+        f.write(f"complyc = {plan.complyc}\n")
+        f.write(f"flags = {plan.flags}\n\n")
+        f.write("rule complyc_file\n"
+                "  command = $complyc $flags --json-report $out $in > $out.log\n"
+                "  description = COMPLYC $in\n\n")
+        f.write("rule complyc_merge\n"
+                "  command = $complyc merge --ordered -o $out @$out.rsp\n"
+                "  rspfile = $out.rsp\n"
+                "  rspfile_content = $in\n"
+                "  description = COMPLYC merge $out\n\n")
+        for src, stamp, headers in plan.units:
+            implicit = " ".join(e(p) for p in [plan.rules, *headers])
+            f.write(f"build {e(stamp)}: complyc_file {e(src)} | {implicit}\n")
+        stamps = " ".join(e(stamp) for _, stamp, _ in plan.units)
+        f.write(f"\nbuild {e(plan.report)}: complyc_merge {stamps}\n")
+        f.write(f"default {e(plan.report)}\n")
+    return len(plan.units)
+
+
+# ---------- make ----------
+
+def _make_escape(path: str) -> str:
+    return path.replace("$", "$$").replace("#", "\\#").replace(" ", "\\ ")
+
+
+def write_make(build_file: str, sources, rules_path, use_gcc, cache_dir, stamp_dir, report=None) -> int:
+    plan = _Plan(build_file, sources, rules_path, use_gcc, cache_dir, stamp_dir, report)
+    e = _make_escape
+    with open(build_file, "w", encoding="utf-8") as f:
+        f.write("# Generated by complyc --emit-make; regenerate when files are added or removed.\n"
+                "# Run with: make -f <this file> -jN   (GNU make 4.0 or newer)\n\n")
+        f.write(f"COMPLYC := {plan.complyc.replace('$', '$$')}\n")
+        f.write(f"COMPLYC_FLAGS := {plan.flags.replace('$', '$$')}\n")
+        f.write(f"COMPLYC_REPORT := {e(plan.report)}\n")
+        f.write("COMPLYC_STAMPS := \\\n")
+        for _, stamp, _ in plan.units:
+            f.write(f"  {e(stamp)} \\\n")
+        f.write("\n\n")
+        f.write(".PHONY: complyc\ncomplyc: $(COMPLYC_REPORT)\n\n")
+        f.write("$(COMPLYC_REPORT): $(COMPLYC_STAMPS)\n"
+                "\t$(file >$@.rsp,$^)\n"
+                "\t$(COMPLYC) merge --ordered -o $@ @$@.rsp\n\n")
+        for src, stamp, headers in plan.units:
+            deps = " ".join(e(p) for p in [src, plan.rules, *headers])
+            f.write(f"{e(stamp)}: {deps}\n"
+                    f"\t@mkdir -p $(@D)\n"
+                    f"\t$(COMPLYC) $(COMPLYC_FLAGS) --json-report $@ $< > $@.log\n")
+    return len(plan.units)
@@ -0,0 +1,112 @@
+"""
+cache.py – Content-addressed per-file result cache for ComplyC
+
+Results are keyed by the git blob hash of the file content together with a
+fingerprint of the rule set and preprocessor mode (and, in GCC mode, the blob
+hashes of the project headers the file includes). Because the key is the git
+blob id, files can be looked up straight from `git ls-tree` output without
+reading them, and identical content under different paths or revisions is
+analyzed only once.
+
+Entries are stored path-independent; the file name is attached on load.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+from .metrics import METRIC_FIELDS, FunctionMetrics
+from .rule_engine import Violation
+
+
+# Bump when rule-engine semantics change in a way that invalidates old entries
+CACHE_VERSION = 1
+
+
+def git_blob_hash(data: bytes) -> str:
+    """SHA-1 of data as git would store it ("blob <len>\\0<data>")."""
+    h = hashlib.sha1()
+    h.update(b"blob %d\0" % len(data))
+    h.update(data)
+    return h.hexdigest()
+
+
+def file_blob_hash(path: str) -> str:
+    with open(path, "rb") as f:
+        return git_blob_hash(f.read())
+
+
+def rules_fingerprint(rules: List[Dict[str, Any]], use_gcc: bool) -> str:
+    """Stable digest of everything besides file content that affects results."""
+    payload = json.dumps(
+        {"version": CACHE_VERSION, "use_gcc": use_gcc, "rules": rules},
+        sort_keys=True,
+        default=str,
+    )
+    return hashlib.sha1(payload.encode("utf-8")).hexdigest()
+
+
+def result_key(rules_fp: str, blob: str, dep_blobs: Iterable[str] = ()) -> str:
+    h = hashlib.sha1(rules_fp.encode("ascii"))
+    h.update(blob.encode("ascii"))
+    for dep in sorted(dep_blobs):
+        h.update(dep.encode("ascii"))
+    return h.hexdigest()
+
+
+class ResultCache:
+    """One small JSON file per key under <cache_dir>/results/xx/."""
+
+    def __init__(self, cache_dir: str):
+        self.root = os.path.join(cache_dir, "results")
+        self.hits = 0
+        self.misses = 0
+
+    def _path(self, key: str) -> str:
+        return os.path.join(self.root, key[:2], key + ".json")
+
+    def get(
+        self, key: str, file_path: str, want_metrics: bool = False
+    ) -> Optional[Tuple[List[Violation], Optional[List[FunctionMetrics]]]]:
+        try:
+            with open(self._path(key), "r", encoding="utf-8") as f:
+                entry = json.load(f)
+        except (OSError, ValueError):
+            self.misses += 1
+            return None
+        if want_metrics and entry.get("metrics") is None:
+            self.misses += 1
+            return None
+
+        self.hits += 1
+        violations = [
+            Violation(rule_id=r, message=m, file=file_path, line=ln, severity=sev, reference=ref)
+            for r, m, ln, sev, ref in entry["violations"]
+        ]
+        metrics = None
+        if want_metrics:
+            metrics = [FunctionMetrics(file_path, *row) for row in entry["metrics"]]
+        return violations, metrics
+
+    def put(
+        self,
+        key: str,
+        violations: List[Violation],
+        metrics: Optional[List[FunctionMetrics]] = None,
+    ):
+        entry = {
+            "violations": [[v.rule_id, v.message, v.line, v.severity, v.reference] for v in violations],
+            "metrics": None,
+        }
+        if metrics is not None:
+            # Everything but the leading "file" column
+            entry["metrics"] = [[getattr(m, name) for name in METRIC_FIELDS[1:]] for m in metrics]
+        path = self._path(key)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        tmp = f"{path}.{os.getpid()}.tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(entry, f, separators=(",", ":"))
+        os.replace(tmp, path)
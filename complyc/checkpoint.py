@@ -0,0 +1,179 @@
+"""
+checkpoint.py – Resumable runs (`--checkpoint` / `--resume`)
+
+With --checkpoint every finished file is appended to a journal (NDJSON) as
+soon as its result is final: its results plus the signature of its inputs
+(mtime and size of the file and, in GCC mode, of the headers it includes;
+see runner.file_signature). A run that is interrupted, killed or OOM-killed
+loses at most the files that were in flight.
+
+--resume reads the journal back, takes the results of every file whose
+signature still matches and analyzes only the rest; results are yielded in
+input order, so console output and reports are the same as for a run that
+was never interrupted. A journal written for other rules, another
+preprocessor mode or without metrics (when metrics are wanted now) is not
+used. The journal is removed once the run has finished and written its
+reports.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import time
+from typing import Any, Callable, Dict, Iterable, Iterator, List, Optional, Tuple
+
+from .cache import rules_fingerprint
+from .discovery import norm_path
+from .metrics import FunctionMetrics
+from .rule_engine import Violation
+from .runner import file_signature, metrics_to_tuple, violation_to_tuple
+
+JOURNAL_VERSION = 1
+DEFAULT_NAME = "checkpoint.ndjson"
+
+# Lines are flushed at once (enough when only the process dies); fsync at
+# most this often bounds what a machine crash can take.
+FSYNC_SECONDS = 2.0
+
+
+def _jsonable(sig: tuple) -> list:
+    return [list(part) for part in sig]
+
+
+class Journal:
+    def __init__(self, path: str, rules: List[Dict[str, Any]], use_gcc: bool, want_metrics: bool):
+        self.path = path
+        self.use_gcc = use_gcc
+        self.want_metrics = want_metrics
+        self.header = {
+            "checkpoint": JOURNAL_VERSION,
+            "rules": rules_fingerprint(rules, use_gcc),
+            "metrics": want_metrics,
+        }
+        self.entries: Dict[str, Dict[str, Any]] = {}
+        self._f = None
+        self._last_sync = time.monotonic()
+
+    # ---------- reading ----------
+
+    def load(self):
+        """Read a previous journal; a truncated last line (crash) is ignored."""
+        try:
+            f = open(self.path, "r", encoding="utf-8")
+        except FileNotFoundError:
+            return
+        with f:
+            try:
+                header = json.loads(f.readline() or "null")
+            except ValueError:
+                header = None
+            if not header or header.get("checkpoint") != JOURNAL_VERSION \
+                    or header.get("rules") != self.header["rules"] \
+                    or (self.want_metrics and not header.get("metrics")):
+                print(f"[ComplyC] Checkpoint {self.path} was written for other rules or "
+                      f"options; starting over")
+                return
+            for line in f:
+                try:
+                    entry = json.loads(line)
+                except ValueError:
+                    break
+                self.entries[entry["key"]] = entry  # later lines win
+
+    def reusable(self, path: str) -> Optional[Tuple[List[Violation], Optional[List[FunctionMetrics]]]]:
+        entry = self.entries.get(norm_path(path))
+        if entry is None:
+            return None
+        sig = file_signature(path, self.use_gcc)
+        if sig is None or _jsonable(sig) != entry["sig"]:
+            return None
+        violations = [Violation(t[0], t[1], path, *t[3:]) for t in entry["violations"]]
+        metrics = None
+        if self.want_metrics:
+            metrics = [FunctionMetrics(path, *t[1:]) for t in entry["metrics"]]
+        return violations, metrics
+
+    # ---------- writing ----------
+
+    def open(self):
+        """Start the journal, keeping the entries loaded (compacted) if any."""
+        os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+        tmp = f"{self.path}.{os.getpid()}.tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            f.write(json.dumps(self.header) + "\n")
+            for entry in self.entries.values():
+                f.write(json.dumps(entry) + "\n")
+        os.replace(tmp, self.path)
+        self._f = open(self.path, "a", encoding="utf-8")
+
+    def record(self, path: str, violations, metrics, sig: Optional[tuple]):
+        if sig is None:
+            return  # vanished meanwhile: nothing to resume from
+        entry = {
+            "key": norm_path(path),
+            "sig": _jsonable(sig),
+            "violations": [violation_to_tuple(v) for v in violations],
+            "metrics": [metrics_to_tuple(m) for m in metrics] if metrics is not None else None,
+        }
+        self._f.write(json.dumps(entry) + "\n")
+        self._f.flush()
+        now = time.monotonic()
+        if now - self._last_sync >= FSYNC_SECONDS:
+            os.fsync(self._f.fileno())
+            self._last_sync = now
+
+    def finish(self):
+        """The run completed: the journal is no longer needed."""
+        self.close()
+        try:
+            os.remove(self.path)
+        except OSError:
+            pass
+
+    def close(self):
+        if self._f is not None:
+            self._f.close()
+            self._f = None
+
+
+def iter_checkpointed(
+    paths: Iterable[str],
+    journal: Journal,
+    resume: bool,
+    analyze: Callable[[List[str]], Iterator[Tuple[str, List[Violation], Optional[List[FunctionMetrics]]]]],
+) -> Iterator[Tuple[str, List[Violation], Optional[List[FunctionMetrics]]]]:
+    """
+    Yield (path, violations, metrics) for all paths in input order, taking
+    unchanged files from the journal (if resuming) and running analyze() on
+    the others; every new result is journaled before it is yielded.
+    """
+    if resume:
+        journal.load()
+    journal.open()
+
+    paths = list(paths)
+    reused: Dict[int, Tuple[List[Violation], Optional[List[FunctionMetrics]]]] = {}
+    to_analyze: List[str] = []
+    signatures: Dict[str, Optional[tuple]] = {}
+    for i, p in enumerate(paths):
+        hit = journal.reusable(p) if resume else None
+        if hit is not None:
+            reused[i] = hit
+        else:
+            # Taken before analysis: an edit during the run must not be masked
+            signatures[p] = file_signature(p, journal.use_gcc)
+            to_analyze.append(p)
+    if resume:
+        print(f"[ComplyC] Resuming from {journal.path}: {len(reused)} file(s) done, "
+              f"analyzing {len(to_analyze)}")
+
+    analyzed = analyze(to_analyze)
+    for i, p in enumerate(paths):
+        if i in reused:
+            violations, metrics = reused.pop(i)
+            yield p, violations, metrics
+            continue
+        path, violations, metrics = next(analyzed)
+        journal.record(path, violations, metrics, signatures.get(path))
+        yield path, violations, metrics
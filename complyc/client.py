@@ -0,0 +1,100 @@
+"""
+client.py – Thin client for the ComplyC daemon
+
+Takes exactly the arguments of `python -m complyc.main`, forwards them with
+the current directory to the daemon (see server.py) and prints the daemon's
+output. Only stdlib modules are imported here, so a call costs a Python
+start-up plus one socket round trip.
+
+If no daemon is listening, the analysis runs in-process instead (unless
+--no-fallback is given).
+
+Usage:
+    python -m complyc.client [--socket PATH] --rules rules.yml file.c ...
+    python -m complyc.client --stop
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import socket
+import sys
+from typing import Any, Dict, List, Optional
+
+
+def default_socket_path() -> str:
+    runtime_dir = os.environ.get("XDG_RUNTIME_DIR")
+    if runtime_dir and os.path.isdir(runtime_dir):
+        return os.path.join(runtime_dir, "complyc.sock")
+    return os.path.join("/tmp", f"complyc-{os.getuid()}.sock")
+
+
+def call(socket_path: str, method: str, params: Optional[Dict[str, Any]] = None,
+         timeout: Optional[float] = None) -> Any:
+    """Send one JSON-RPC 2.0 request (newline-delimited) and return its result."""
+    request = {"jsonrpc": "2.0", "id": 1, "method": method, "params": params or {}}
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.settimeout(timeout)
+        sock.connect(socket_path)
+        sock.sendall(json.dumps(request).encode("utf-8") + b"\n")
+        with sock.makefile("rb") as f:
+            line = f.readline()
+    if not line:
+        raise ConnectionError("daemon closed the connection")
+    response = json.loads(line)
+    if "error" in response:
+        raise RuntimeError(response["error"].get("message", "daemon error"))
+    return response["result"]
+
+
+def _take_option(argv: List[str], name: str, has_value: bool):
+    """Remove a client-only option from argv; return its value (or True)."""
+    for i, arg in enumerate(argv):
+        if arg == name:
+            del argv[i]
+            return argv.pop(i) if has_value else True
+        if has_value and arg.startswith(name + "="):
+            del argv[i]
+            return arg.split("=", 1)[1]
+    return None
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    argv = list(sys.argv[1:] if argv is None else argv)
+    socket_path = _take_option(argv, "--socket", True) or default_socket_path()
+    no_fallback = _take_option(argv, "--no-fallback", False)
+
+    if _take_option(argv, "--stop", False):
+        try:
+            call(socket_path, "shutdown", timeout=5)
+            print("[ComplyC] Daemon stopped")
+            return 0
+        except OSError:
+            print("[ComplyC] No daemon listening on", socket_path)
+            return 1
+
+    try:
+        if "--watch" in argv:
+            # Long-running by nature: never tie up the daemon with it
+            raise ConnectionRefusedError
+        result = call(socket_path, "run", {"argv": argv, "cwd": os.getcwd()})
+    except (FileNotFoundError, ConnectionRefusedError):
+        if no_fallback and "--watch" not in argv:
+            print(f"[ComplyC] No daemon listening on {socket_path}", file=sys.stderr)
+            return 2
+        # No daemon: behave exactly like the regular CLI
+        from .main import main as local_main
+        try:
+            return local_main(argv)
+        except SystemExit as e:
+            return e.code if isinstance(e.code, int) else (0 if e.code is None else 1)
+
+    sys.stdout.write(result.get("stdout", ""))
+    sys.stderr.write(result.get("stderr", ""))
+    sys.stdout.flush()
+    return int(result.get("exit_code", 0))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,208 @@
+"""
+compact.py – Compact JSON report schema v2 (`--json-schema 2`, `convert`)
+
+In the v1 report every violation repeats its rule's severity, reference and
+guidance text (embedded in the message) and its file path. v2 stores those
+once, in tables, and each violation as a small array:
+
+    {
+      "version": 2,
+      "shard": {...},                                  (shard runs only)
+      "rules": [
+        {"id": "NAMING_FUNC_001", "severity": "major", "reference": "...",
+         "message_suffix": " Rename function to lower_snake_case ..."},
+        ...
+      ],
+      "violations": [
+        [0, 0, 32, "Name 'BadFunctionName' does not match pattern '^[a-z][a-z0-9_]*$'."],
+        ...
+      ],
+      "files": ["src/a.c", "src/b.c", ...],
+      "summary": {...}, "run": {...}, "sample": {...}   (as in v1)
+    }
+
+A violation is [rule_idx, file_idx, line, args]: the message is args plus
+the rule's message_suffix (the guidance the checks append). A message that
+does not end in its rule's suffix is kept whole as args = {"message": ...};
+a violation of a rule missing from the table has rule_idx null and args
+{"rule_id", "message", "severity", "reference"}. Violations are grouped by
+file, in file order; "files" lists every analyzed file (clean ones too), so
+the table comes last and the report is still written as files complete.
+
+Like v1 reports, a .gz or .zst file name compresses the report. `complyc
+convert` turns a v2 report back into the v1 layout, byte-identical to the v1
+report of the same run (streamed: only the tables are held in memory):
+
+    python -m complyc.main convert report.v2.json.gz -o report.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+from typing import Any, Dict, Iterable, Iterator, List, Optional
+
+from .merge import ReportReader
+from .reporters import JsonReportWriter, open_report, write_summary_file
+
+SCHEMA_VERSION = 2
+
+
+def _line(value: Any) -> str:
+    return json.dumps(value, separators=(",", ":"), ensure_ascii=False)
+
+
+class CompactReportFile:
+    """v2 counterpart of reporters.JsonReportFile (same add/close interface)."""
+
+    def __init__(
+        self,
+        outfile: str,
+        rules: List[Dict[str, Any]],
+        head: Optional[Dict[str, Any]] = None,
+        summary_path: Optional[str] = None,
+    ):
+        self.outfile = outfile
+        self.summary_path = summary_path
+        self.partial = outfile + ".partial"
+        self._flush = not outfile.lower().endswith((".gz", ".zst"))
+        self.rules = [
+            {
+                "id": rule["id"],
+                "severity": rule.get("severity"),
+                "reference": rule.get("reference"),
+                "message_suffix": f" {rule.get('guidance', '')}",
+            }
+            for rule in rules
+        ]
+        self.rule_index = {rule["id"]: i for i, rule in enumerate(self.rules)}
+        self.files: List[str] = []
+        self.total_violations = 0
+        self.by_severity: Dict[str, int] = {}
+
+        self.out = open_report(self.partial, "w", like=outfile)
+        self.out.write('{\n  "version": %d,\n' % SCHEMA_VERSION)
+        for key, value in (head or {}).items():
+            self.out.write(f"  {json.dumps(key)}: {_line(value)},\n")
+        self.out.write('  "rules": [\n    ' + ",\n    ".join(_line(r) for r in self.rules) + "\n  ],\n")
+        self.out.write('  "violations": [')
+
+    def _compact(self, v) -> list:
+        index = self.rule_index.get(v.rule_id)
+        rule = self.rules[index] if index is not None else None
+        if rule is None or (v.severity, v.reference) != (rule["severity"], rule["reference"]):
+            return [None, len(self.files), v.line, {
+                "rule_id": v.rule_id, "message": v.message, "severity": v.severity, "reference": v.reference,
+            }]
+        suffix = rule["message_suffix"]
+        if v.message.endswith(suffix):
+            args: Any = v.message[:len(v.message) - len(suffix)]
+        else:
+            args = {"message": v.message}
+        return [index, len(self.files), v.line, args]
+
+    def add(self, path: str, violations: Iterable[Any]):
+        for v in violations:
+            self.out.write(",\n    " if self.total_violations else "\n    ")
+            self.out.write(_line(self._compact(v)))
+            self.total_violations += 1
+            sev = v.severity or "unspecified"
+            self.by_severity[sev] = self.by_severity.get(sev, 0) + 1
+        self.files.append(path)
+        if self._flush:
+            self.out.flush()
+
+    def close(self, tail: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        summary = {
+            "total_files": len(self.files),
+            "total_violations": self.total_violations,
+            "by_severity": dict(self.by_severity),
+        }
+        self.out.write("\n  ],\n" if self.total_violations else "],\n")
+        files = ",\n    ".join(_line(f) for f in self.files)
+        self.out.write('  "files": [' + (f"\n    {files}\n  " if self.files else "") + "],\n")
+        self.out.write('  "summary": ' + _line(summary))
+        for key, value in (tail or {}).items():
+            self.out.write(f",\n  {json.dumps(key)}: {_line(value)}")
+        self.out.write("\n}\n")
+        self.out.close()
+        os.replace(self.partial, self.outfile)
+        print(f"[ComplyC] JSON report (schema v2) written to {self.outfile}")
+        if self.summary_path:
+            write_summary_file(self.summary_path, self.outfile, summary, tail)
+        return summary
+
+
+# ---------- back to v1 ----------
+
+def _expand(doc: Dict[str, Any], row: list) -> Dict[str, Any]:
+    """v1 violation dict (rule_engine.Violation field order) of one v2 row."""
+    rule_idx, file_idx, line, args = row
+    path = doc["files"][file_idx]
+    if rule_idx is None:
+        return {"rule_id": args["rule_id"], "message": args["message"], "file": path, "line": line,
+                "severity": args["severity"], "reference": args["reference"]}
+    rule = doc["rules"][rule_idx]
+    message = args["message"] if isinstance(args, dict) else args + rule["message_suffix"]
+    return {"rule_id": rule["id"], "message": message, "file": path, "line": line,
+            "severity": rule["severity"], "reference": rule["reference"]}
+
+
+def iter_v1_entries(doc: Dict[str, Any], rows: Iterable[list]) -> Iterator[Dict[str, Any]]:
+    """The v1 {"file", "violations"} entries of a v2 report's rows, in file order."""
+    rows = iter(rows)
+    pending = next(rows, None)
+    for file_idx, path in enumerate(doc["files"]):
+        violations = []
+        while pending is not None and pending[1] == file_idx:
+            violations.append(_expand(doc, pending))
+            pending = next(rows, None)
+        yield {"file": path, "violations": violations}
+
+
+def convert_to_v1(infile: str, outfile: str):
+    """
+    Stream infile to a v1 report. A v2 report is read twice: once for the
+    tables (the file table follows the rows), then for the rows themselves,
+    so only the tables are held in memory.
+    """
+    reader = ReportReader(infile, arrays=("files", "violations"), versioned=True)
+    version = reader.header.get("version")
+    if reader.array == "violations" and version == SCHEMA_VERSION:
+        for _ in reader.iter_files():
+            pass
+        doc = {**reader.header, **reader.trailer}
+        rows = ReportReader(infile, arrays=("violations",), versioned=True)
+        entries: Iterable[Dict[str, Any]] = iter_v1_entries(doc, rows.iter_files())
+        trailer = doc
+    elif reader.array == "files" and version is None:
+        entries = reader.iter_files()  # already v1: re-written (e.g. to (de)compress it)
+        trailer = reader.trailer
+    else:
+        reader.close()
+        raise ValueError(f"{infile}: not a ComplyC JSON report")
+    head = {"shard": reader.header["shard"]} if "shard" in reader.header else None
+    with open_report(outfile, "w") as out:
+        writer = JsonReportWriter(out, head)
+        for entry in entries:
+            writer.add_entry(entry)
+        # The v1 trailer blocks are only known once the files are read
+        writer.finish({k: trailer[k] for k in ("run", "sample") if k in trailer})
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(
+        prog="complyc convert",
+        description="Convert a ComplyC JSON report (schema v2, or v1) to the v1 layout",
+    )
+    parser.add_argument("input", help="Report to convert (.json, .json.gz or .json.zst)")
+    parser.add_argument("-o", "--output", required=True,
+                        help="v1 report to write (.gz / .zst to compress it)")
+    args = parser.parse_args(argv)
+    try:
+        convert_to_v1(args.input, args.output)
+    except (OSError, ValueError, KeyError, IndexError, TypeError) as e:
+        parser.exit(1, f"[ComplyC] Cannot convert {args.input}: {e}\n")
+    print(f"[ComplyC] v1 report written to {args.output}")
+    return 0
@@ -0,0 +1,65 @@
+"""
+console.py – Console output shared by the CLI, the daemon client and the merger
+
+Deliberately import-light (no yaml / pycparser), so the thin daemon client
+can print exactly what the regular CLI prints without paying for them.
+Violations may be Violation objects or any object with rule_id/line/message.
+
+Non-fatal problems found by shared code (an unreadable directory, a rule
+check that raised) go through warn(): the CLI prints them like every other
+console line, library callers get them as warnings of the "complyc" logger.
+"""
+
+from __future__ import annotations
+
+from typing import Any, Iterable, Mapping
+
+# Set once by the CLI entry point (see print_warnings)
+_print_warnings = False
+
+
+def print_warnings(enabled: bool = True):
+    """Print warn() messages to the console instead of logging them."""
+    global _print_warnings
+    _print_warnings = enabled
+
+
+def warn(message: str):
+    if _print_warnings:
+        print(f"[ComplyC] {message}")
+        return
+    import logging  # only when something goes wrong (start-up time)
+
+    logging.getLogger("complyc").warning(message)
+
+
+def print_file_result(path: str, violations: Iterable[Any]):
+    """Per-file block: header line plus one line per violation."""
+    violations = list(violations)
+    print(f"\nFile: {path}")
+    if not violations:
+        print("  No violations found ✅")
+    else:
+        for v in violations:
+            line = f"line {v.line}" if v.line is not None else "line ?"
+            print(f"  [{v.rule_id}] {line}: {v.message}")
+
+
+def print_summary_header(total_files: int, total_violations: int, by_severity: Mapping[str, int]):
+    """Opening part of the summary block (callers may add lines, then print_summary_footer)."""
+    print("\n==================== Summary ====================")
+    print(f"Total files analyzed   : {total_files}")
+    print(f"Total violations found : {total_violations}")
+
+    if total_violations == 0:
+        print("Overall status         : ✅ Clean (no violations)")
+    else:
+        print("Overall status         : ⚠️ Issues detected")
+        print("Violations by severity :")
+        for sev, count in sorted(by_severity.items()):
+            label = sev.capitalize()
+            print(f"  - {label:11} : {count}")
+
+
+def print_summary_footer():
+    print("=================================================\n")
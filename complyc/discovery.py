@@ -0,0 +1,374 @@
+"""
+discovery.py – Source file discovery for ComplyC
+
+Expands the command-line inputs (files, directories, glob patterns) into a
+lazy stream of source paths. Directories are walked with os.scandir and every
+match is yielded as soon as it is found, so analysis can start before the
+walk finishes.
+
+Include rules are basename globs (default *.c / *.h). Exclude rules and
+.gitignore files use gitignore syntax: '!' negation, trailing '/' for
+directories only, a '/' inside the pattern anchors it to the directory that
+defines it, and '**' matches across directories. As in git, files inside an
+ignored directory cannot be re-included.
+"""
+
+from __future__ import annotations
+
+import fnmatch
+import os
+import re
+from typing import Callable, Dict, Iterable, Iterator, List, Optional, Sequence, Tuple
+
+from .console import warn
+
+
+DEFAULT_INCLUDES = ("*.c", "*.h")
+
+_GLOB_CHARS = re.compile(r"[*?\[]")
+
+
+def norm_path(path: str) -> str:
+    """Canonical cwd-relative spelling used for graph and git lookups."""
+    return os.path.normpath(os.path.relpath(path))
+
+
+# ---------- gitignore-style patterns ----------
+
+def _translate(pat: str) -> str:
+    """Translate one gitignore glob (already stripped of '!' and '/') to a regex."""
+    out = []
+    i, n = 0, len(pat)
+    while i < n:
+        c = pat[i]
+        if pat.startswith("**/", i):
+            out.append("(?:.*/)?")
+            i += 3
+        elif pat.startswith("/**", i) and i + 3 == n:
+            out.append("/.*")
+            i += 3
+        elif pat.startswith("**", i):
+            out.append(".*")
+            i += 2
+        elif c == "*":
+            out.append("[^/]*")
+            i += 1
+        elif c == "?":
+            out.append("[^/]")
+            i += 1
+        elif c == "[":
+            j = pat.find("]", i + 1)
+            if j == -1:
+                out.append(re.escape(c))
+                i += 1
+            else:
+                body = pat[i + 1:j]
+                if body.startswith("!"):
+                    body = "^" + body[1:]
+                out.append(f"[{body}]")
+                i = j + 1
+        elif c == "\\" and i + 1 < n:
+            out.append(re.escape(pat[i + 1]))
+            i += 2
+        else:
+            out.append(re.escape(c))
+            i += 1
+    return "".join(out)
+
+
+class IgnoreRules:
+    """An ordered list of gitignore-style patterns relative to one base directory."""
+
+    def __init__(self, base: str, lines: Iterable[str]):
+        self.base = base
+        self.rules: List[Tuple[re.Pattern, bool, bool]] = []  # (regex, negate, dir_only)
+        for raw in lines:
+            line = raw.rstrip("\n").rstrip()
+            if not line or line.startswith("#"):
+                continue
+            negate = line.startswith("!")
+            if negate:
+                line = line[1:]
+            elif line.startswith("\\"):
+                line = line[1:]
+            dir_only = line.endswith("/")
+            line = line.rstrip("/")
+            if not line:
+                continue
+            anchored = "/" in line
+            line = line.lstrip("/")
+            regex = _translate(line)
+            if not anchored:
+                regex = "(?:.*/)?" + regex
+            self.rules.append((re.compile(regex + r"\Z"), negate, dir_only))
+
+    @classmethod
+    def from_file(cls, base: str, path: str) -> Optional["IgnoreRules"]:
+        try:
+            with open(path, "r", encoding="utf-8", errors="replace") as f:
+                rules = cls(base, f)
+        except OSError:
+            return None
+        return rules if rules.rules else None
+
+    def match(self, path: str, is_dir: bool) -> Optional[bool]:
+        """True = ignored, False = re-included, None = no rule applies."""
+        rel = os.path.relpath(path, self.base).replace(os.sep, "/")
+        if rel.startswith("../"):
+            return None
+        result = None
+        for regex, negate, dir_only in self.rules:
+            if dir_only and not is_dir:
+                continue
+            if regex.match(rel):
+                result = not negate
+        return result
+
+
+def _is_ignored(path: str, is_dir: bool, stack: Sequence[IgnoreRules]) -> bool:
+    ignored = False
+    for rules in stack:
+        verdict = rules.match(path, is_dir)
+        if verdict is not None:
+            ignored = verdict
+    return ignored
+
+
+def _ancestor_gitignores(root: str) -> List[IgnoreRules]:
+    """.gitignore files from the enclosing git work tree down to (excluding) root."""
+    root_abs = os.path.abspath(root)
+    chain = []
+    cur = os.path.dirname(root_abs)
+    while True:
+        chain.append(cur)
+        if os.path.exists(os.path.join(cur, ".git")):
+            break
+        parent = os.path.dirname(cur)
+        if parent == cur:
+            # Not inside a git work tree: ancestors do not apply
+            return []
+        cur = parent
+
+    stack = []
+    for d in reversed(chain):
+        rel_base = os.path.relpath(d)
+        rules = IgnoreRules.from_file(rel_base, os.path.join(d, ".gitignore"))
+        if rules:
+            stack.append(rules)
+    return stack
+
+
+# ---------- walking ----------
+
+def _walk(
+    root: str,
+    want: Callable[[str, str], bool],
+    base_stack: List[IgnoreRules],
+    use_gitignore: bool,
+    max_depth: Optional[int] = None,
+) -> Iterator[str]:
+    """Depth-first, name-sorted scandir walk yielding wanted files immediately."""
+    stack: List[Tuple[str, List[IgnoreRules], int]] = [(root, base_stack, 1)]
+    while stack:
+        directory, ignores, depth = stack.pop()
+        if use_gitignore:
+            local = IgnoreRules.from_file(directory, os.path.join(directory, ".gitignore"))
+            if local:
+                ignores = ignores + [local]
+        try:
+            with os.scandir(directory) as it:
+                entries = sorted(it, key=lambda e: e.name)
+        except OSError as e:
+            warn(f"Cannot read directory {directory}: {e}")
+            continue
+
+        subdirs = []
+        for entry in entries:
+            path = os.path.join(directory, entry.name) if directory != "." else entry.name
+            try:
+                is_dir = entry.is_dir()
+            except OSError:
+                continue
+            if is_dir:
+                if entry.name == ".git" or _is_ignored(path, True, ignores):
+                    continue
+                if max_depth is None or depth < max_depth:
+                    subdirs.append(path)
+            elif want(path, entry.name) and not _is_ignored(path, False, ignores):
+                yield path
+
+        # Push in reverse so directories are visited in name order
+        for sub in reversed(subdirs):
+            stack.append((sub, ignores, depth + 1))
+
+
+class IgnoreChecker:
+    """
+    Decides for single paths (e.g. files reported changed by a watcher) what
+    _walk decides while walking root: excludes and .gitignore files apply,
+    and a path below an ignored directory is ignored too. The .gitignore of
+    each directory is read once; forget() drops them after one changed.
+    """
+
+    def __init__(self, root: str, excludes: Optional[Sequence[str]] = None, use_gitignore: bool = True):
+        self.root = root
+        self.use_gitignore = use_gitignore
+        self.base_stack = _ancestor_gitignores(root) if use_gitignore else []
+        if excludes:
+            self.base_stack = self.base_stack + [IgnoreRules(root, excludes)]
+        self._local: Dict[str, Optional[IgnoreRules]] = {}
+
+    def _local_rules(self, directory: str) -> List[IgnoreRules]:
+        if not self.use_gitignore:
+            return []
+        if directory not in self._local:
+            self._local[directory] = IgnoreRules.from_file(directory, os.path.join(directory, ".gitignore"))
+        local = self._local[directory]
+        return [local] if local else []
+
+    def ignored(self, path: str, is_dir: bool = False) -> bool:
+        rel = os.path.relpath(path, self.root)
+        if rel == os.curdir or rel.startswith(os.pardir):
+            return False
+        parts = rel.split(os.sep)
+        directory, stack = self.root, self.base_stack
+        for i, part in enumerate(parts):
+            stack = stack + self._local_rules(directory)
+            directory = os.path.join(directory, part)
+            last = i == len(parts) - 1
+            if part == ".git" and (is_dir or not last):
+                return True
+            if _is_ignored(directory, is_dir or not last, stack):
+                return True
+        return False
+
+    def forget(self):
+        self._local.clear()
+
+
+def _glob_regex(spec: str) -> re.Pattern:
+    """Regex of a glob spec, matched against normalized paths ('./*.c' is '*.c')."""
+    return re.compile(_translate(os.path.normpath(spec).replace(os.sep, "/")) + r"\Z")
+
+
+def _split_glob(spec: str) -> Tuple[str, Optional[int]]:
+    """Return (literal base directory, max walk depth or None for '**')."""
+    parts = spec.replace(os.sep, "/").split("/")
+    for i, part in enumerate(parts):
+        if _GLOB_CHARS.search(part):
+            base = "/".join(parts[:i]) or "."
+            rest = parts[i:]
+            return base, (None if "**" in spec else len(rest))
+    return spec, 0
+
+
+def iter_sources(
+    specs: Iterable[str],
+    includes: Optional[Sequence[str]] = None,
+    excludes: Optional[Sequence[str]] = None,
+    use_gitignore: bool = True,
+) -> Iterator[str]:
+    """
+    Expand files, directories and glob patterns into a stream of source paths.
+
+    - Explicit files are always yielded (they were asked for by name).
+    - Directories are walked recursively, applying includes, excludes and
+      .gitignore files (including those of enclosing directories up to the
+      git work-tree root).
+    - Glob patterns ('**' allowed) are walked from their literal prefix
+      directory, with excludes and .gitignore applied the same way.
+
+    Each path is yielded once, in a deterministic order.
+    """
+    includes = list(includes) if includes else list(DEFAULT_INCLUDES)
+    excludes = list(excludes or [])
+    seen = set()
+
+    def first_time(path: str) -> bool:
+        key = os.path.normpath(path)
+        if key in seen:
+            return False
+        seen.add(key)
+        return True
+
+    def by_include(path: str, name: str) -> bool:
+        return any(fnmatch.fnmatch(name, pat) for pat in includes)
+
+    for spec in specs:
+        if os.path.isdir(spec):
+            root, want, max_depth = spec, by_include, None
+        elif os.path.exists(spec) or not _GLOB_CHARS.search(spec):
+            # Explicit file (a missing one is passed through so the
+            # analysis reports it like before)
+            if first_time(spec):
+                yield spec
+            continue
+        else:
+            root, max_depth = _split_glob(spec)
+            if not os.path.isdir(root):
+                continue
+            regex = _glob_regex(spec)
+
+            def want(path: str, name: str, regex=regex) -> bool:
+                return regex.match(os.path.normpath(path).replace(os.sep, "/")) is not None
+
+        base_stack = _ancestor_gitignores(root) if use_gitignore else []
+        if excludes:
+            base_stack = base_stack + [IgnoreRules(root, excludes)]
+        for path in _walk(root, want, base_stack, use_gitignore, max_depth):
+            if first_time(path):
+                yield path
+
+
+def _walk_order(path: str):
+    """Sort key reproducing _walk's order: a directory's files, then its subdirectories."""
+    parts = path.split(os.sep)
+    return [(1, d) for d in parts[:-1]] + [(0, parts[-1])]
+
+
+def select_paths(
+    known: Iterable[str],
+    specs: Iterable[str],
+    includes: Optional[Sequence[str]] = None,
+    excludes: Optional[Sequence[str]] = None,
+) -> List[str]:
+    """
+    iter_sources() semantics over a given set of file paths instead of the
+    file system (e.g. the files of a git revision): explicit files, directory
+    prefixes and glob patterns, with includes/excludes applied the same way.
+    """
+    includes = list(includes) if includes else list(DEFAULT_INCLUDES)
+    exclude_rules = IgnoreRules(".", excludes) if excludes else None
+    known = sorted({os.path.normpath(p) for p in known}, key=_walk_order)
+    known_set = set(known)
+
+    def excluded(path: str) -> bool:
+        if exclude_rules is None:
+            return False
+        parts = path.split(os.sep)
+        for i in range(1, len(parts)):
+            if exclude_rules.match(os.sep.join(parts[:i]), True):
+                return True
+        return bool(exclude_rules.match(path, False))
+
+    selected: List[str] = []
+    seen = set()
+    for spec in specs:
+        norm = os.path.normpath(spec)
+        if norm in known_set:
+            matches = [norm]
+        elif _GLOB_CHARS.search(spec):
+            regex = _glob_regex(spec)
+            matches = [p for p in known
+                       if regex.match(p.replace(os.sep, "/")) and not excluded(p)]
+        else:
+            prefix = "" if norm == "." else norm + os.sep
+            matches = [p for p in known
+                       if p.startswith(prefix)
+                       and any(fnmatch.fnmatch(os.path.basename(p), pat) for pat in includes)
+                       and not excluded(p)]
+        for p in matches:
+            if p not in seen:
+                seen.add(p)
+                selected.append(p)
+    return selected
@@ -0,0 +1,184 @@
+"""
+gitsnapshot.py – Analyze a git revision or the index straight from git
+
+`--git-rev REV` analyzes the files as committed in REV, `--git-index` what
+is staged (the pre-commit view), without checking anything out: file lists
+come from `git ls-tree` / `git ls-files -s`, contents from one long-running
+`git cat-file --batch` process, and sources are parsed from memory.
+
+Results go through the content-addressed ResultCache keyed by blob id (and,
+in GCC mode, the blob ids of the included project headers), so a blob that
+was analyzed before - in any revision, under any path - costs a cache
+lookup and is not even read from git.
+
+GCC mode needs files on disk: the analyzed file and the project headers it
+includes are written, as they are in the snapshot, to a temporary mirror.
+"""
+
+from __future__ import annotations
+
+import os
+import shutil
+import tempfile
+from collections import defaultdict
+from typing import Any, Dict, Iterator, List, Optional, Sequence, Set, Tuple
+
+from . import gitutil
+from .cache import ResultCache, result_key, rules_fingerprint
+from .discovery import select_paths
+from .includes import INCLUDE_RE
+from .metrics import FunctionMetrics
+from .rule_engine import Violation
+from .runner import analyze_source
+
+
+class GitSnapshot:
+    """The blobs of one revision (or of the index), readable by path."""
+
+    def __init__(
+        self,
+        rev: Optional[str] = None,
+        batch: Optional[gitutil.CatFileBatch] = None,
+        include_cache: Optional[Dict[str, List[str]]] = None,
+    ):
+        """batch / include_cache may be shared by snapshots of many revisions."""
+        self.rev = rev
+        self.label = f"revision {rev}" if rev else "index"
+        try:
+            self.top = gitutil.git_toplevel()
+            self.blobs: Dict[str, str] = gitutil.ls_tree(rev) if rev else gitutil.index_blobs()
+            self._owns_batch = batch is None
+            self.batch = batch or gitutil.CatFileBatch(cwd=self.top)
+        except gitutil.GitError as e:
+            print(f"[ComplyC] ERROR: cannot read {self.label} from git: {e}")
+            raise SystemExit(2)
+        self.by_basename: Dict[str, List[str]] = defaultdict(list)
+        for path in self.blobs:
+            self.by_basename[os.path.basename(path)].append(path)
+        # blob id -> raw quoted includes
+        self._includes: Dict[str, List[str]] = {} if include_cache is None else include_cache
+        self._mirrored: Set[str] = set()
+
+    # ---------- content ----------
+
+    def data(self, path: str) -> bytes:
+        data = self.batch.read(self.blobs[path])
+        if data is None:
+            raise gitutil.GitError(f"blob of {path} missing from the object store")
+        return data
+
+    def text(self, path: str) -> str:
+        """Decoded content with universal newlines (like a text-mode read)."""
+        return self.data(path).decode("utf-8").replace("\r\n", "\n").replace("\r", "\n")
+
+    def select(
+        self,
+        specs: Sequence[str],
+        includes: Optional[Sequence[str]] = None,
+        excludes: Optional[Sequence[str]] = None,
+    ) -> List[str]:
+        return select_paths(self.blobs.keys(), specs, includes, excludes)
+
+    # ---------- includes (GCC mode) ----------
+
+    def _resolve_includes(self, path: str) -> Set[str]:
+        blob = self.blobs[path]
+        raw = self._includes.get(blob)
+        if raw is None:
+            raw = INCLUDE_RE.findall(self.data(path).decode("utf-8", "replace"))
+            self._includes[blob] = raw
+        resolved = set()
+        base_dir = os.path.dirname(path)
+        for inc in raw:
+            candidate = os.path.normpath(os.path.join(base_dir, inc))
+            if candidate in self.blobs:
+                resolved.add(candidate)
+                continue
+            matches = self.by_basename.get(os.path.basename(inc), [])
+            if len(matches) == 1:
+                resolved.add(matches[0])
+        return resolved
+
+    def include_closure(self, path: str) -> Set[str]:
+        """Snapshot files path (transitively) includes, resolved like IncludeGraph."""
+        result: Set[str] = set()
+        stack = [path]
+        while stack:
+            for child in self._resolve_includes(stack.pop()):
+                if child not in result and child != path:
+                    result.add(child)
+                    stack.append(child)
+        return result
+
+    def materialize(self, path: str, root: str) -> str:
+        """Write path and its header closure under root; return path's copy."""
+        for p in [path, *self.include_closure(path)]:
+            if p in self._mirrored:
+                continue
+            target = os.path.join(root, os.path.relpath(os.path.abspath(p), self.top))
+            os.makedirs(os.path.dirname(target), exist_ok=True)
+            with open(target, "wb") as f:
+                f.write(self.data(p))
+            self._mirrored.add(p)
+        return os.path.join(root, os.path.relpath(os.path.abspath(path), self.top))
+
+    def close(self):
+        if self._owns_batch:
+            self.batch.close()
+
+
+def snapshot_result(
+    snapshot: GitSnapshot,
+    path: str,
+    rules: List[Dict[str, Any]],
+    rules_fp: str,
+    use_gcc: bool,
+    cache: Optional[ResultCache],
+    mirror: Optional[str],
+    want_metrics: bool = False,
+) -> Tuple[str, List[Violation], Optional[List[FunctionMetrics]], bool]:
+    """(result key, violations, metrics, analyzed) for one snapshot path.
+
+    The cache is consulted first; on a miss the blob is read and analyzed
+    (GCC mode: through the mirror directory) and the result stored.
+    """
+    deps = [snapshot.blobs[h] for h in snapshot.include_closure(path)] if use_gcc else []
+    key = result_key(rules_fp, snapshot.blobs[path], deps)
+    hit = cache.get(key, path, want_metrics) if cache else None
+    if hit is not None:
+        return key, hit[0], hit[1], False
+
+    metrics = [] if want_metrics else None
+    gcc_path = snapshot.materialize(path, mirror) if use_gcc else None
+    violations = analyze_source(path, snapshot.text(path), rules, use_gcc, metrics, gcc_path)
+    if cache:
+        cache.put(key, violations, metrics)
+    return key, violations, metrics, True
+
+
+def iter_snapshot(
+    snapshot: GitSnapshot,
+    paths: Sequence[str],
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    cache_dir: Optional[str],
+    want_metrics: bool = False,
+) -> Iterator[Tuple[str, List[Violation], Optional[List[FunctionMetrics]]]]:
+    """Yield (path, violations, metrics) for snapshot paths, in order."""
+    rules_fp = rules_fingerprint(rules, use_gcc)
+    cache = ResultCache(cache_dir) if cache_dir else None
+    mirror = tempfile.mkdtemp(prefix="complyc-git-") if use_gcc else None
+    analyzed = 0
+    try:
+        for path in paths:
+            _key, violations, metrics, fresh = snapshot_result(
+                snapshot, path, rules, rules_fp, use_gcc, cache, mirror, want_metrics
+            )
+            analyzed += fresh
+            yield path, violations, metrics
+    finally:
+        if mirror:
+            shutil.rmtree(mirror, ignore_errors=True)
+
+    print(f"[ComplyC] Git {snapshot.label}: analyzed {analyzed} blob(s), "
+          f"{len(paths) - analyzed} from cache")
@@ -0,0 +1,158 @@
+"""
+gitutil.py – Small git helpers for ComplyC
+
+All paths returned by these helpers are relative to the current working
+directory, matching how files are named everywhere else in ComplyC.
+"""
+
+from __future__ import annotations
+
+import os
+import subprocess
+from typing import Dict, List, Optional, Set, Tuple
+
+
+class GitError(RuntimeError):
+    pass
+
+
+def run_git(args: List[str], cwd: str = ".") -> bytes:
+    """Run a git command and return its stdout (raises GitError on failure)."""
+    cmd = ["git"] + args
+    try:
+        result = subprocess.run(
+            cmd,
+            cwd=cwd,
+            check=True,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+        )
+    except FileNotFoundError:
+        raise GitError("git not found on system PATH")
+    except subprocess.CalledProcessError as e:
+        raise GitError(f"{' '.join(cmd)} failed: {e.stderr.decode('utf-8', 'replace').strip()}")
+    return result.stdout
+
+
+def git_toplevel() -> str:
+    return run_git(["rev-parse", "--show-toplevel"]).decode("utf-8").strip()
+
+
+def _split_z(out: bytes) -> List[str]:
+    return [p.decode("utf-8", "surrogateescape") for p in out.split(b"\0") if p]
+
+
+def _to_cwd_relative(top: str, repo_paths: List[str]) -> List[str]:
+    return [os.path.relpath(os.path.join(top, p)) for p in repo_paths]
+
+
+def changed_files(ref: str) -> Set[str]:
+    """
+    Files that differ between ref and the working tree, plus untracked files.
+
+    Deleted files are included too; callers simply won't find them on disk.
+    """
+    top = git_toplevel()
+    diff = _split_z(run_git(["diff", "--name-only", "-z", ref, "--"], cwd=top))
+    untracked = _split_z(run_git(["ls-files", "--others", "--exclude-standard", "-z"], cwd=top))
+    return set(_to_cwd_relative(top, diff + untracked))
+
+
+def ls_tree(rev: str) -> Dict[str, str]:
+    """Map every blob path in rev (cwd-relative) to its blob SHA-1."""
+    top = git_toplevel()
+    out = run_git(["ls-tree", "-r", "-z", "--full-tree", rev], cwd=top)
+    blobs: Dict[str, str] = {}
+    for entry in out.split(b"\0"):
+        if not entry:
+            continue
+        meta, _, path = entry.partition(b"\t")
+        _mode, obj_type, sha = meta.decode("ascii").split()
+        if obj_type != "blob":
+            continue
+        rel = os.path.relpath(os.path.join(top, path.decode("utf-8", "surrogateescape")))
+        blobs[rel] = sha
+    return blobs
+
+
+def log_commits(rev_range: str, max_count: Optional[int] = None) -> List[Tuple[str, str, str]]:
+    """(sha, committer date ISO 8601, subject) along the first-parent line, oldest first."""
+    args = ["log", "--first-parent", "--format=%H%x09%cI%x09%s"]
+    if max_count:
+        args.append(f"--max-count={max_count}")
+    out = run_git(args + [rev_range, "--"])
+    commits = []
+    for line in out.decode("utf-8", "replace").splitlines():
+        sha, date, subject = (line.split("\t", 2) + ["", ""])[:3]
+        commits.append((sha, date, subject))
+    commits.reverse()
+    return commits
+
+
+def index_blobs() -> Dict[str, str]:
+    """Map every staged blob path (cwd-relative) to its blob SHA-1.
+
+    Unmerged paths use "ours" (stage 2); gitlinks and symlinks are skipped.
+    """
+    top = git_toplevel()
+    out = run_git(["ls-files", "-s", "-z"], cwd=top)
+    blobs: Dict[str, str] = {}
+    stages: Dict[str, str] = {}
+    for entry in out.split(b"\0"):
+        if not entry:
+            continue
+        meta, _, path = entry.partition(b"\t")
+        mode, sha, stage = meta.decode("ascii").split()
+        if not mode.startswith("100"):
+            continue
+        rel = os.path.relpath(os.path.join(top, path.decode("utf-8", "surrogateescape")))
+        if stage == "0" or (stage == "2" and stages.get(rel) != "0"):
+            blobs[rel] = sha
+            stages[rel] = stage
+    return blobs
+
+
+class CatFileBatch:
+    """
+    One long-running `git cat-file --batch` process.
+
+    Objects are requested one at a time over its stdin, so reading many
+    blobs costs a single git start-up instead of one per file.
+    """
+
+    def __init__(self, cwd: str = "."):
+        try:
+            self._proc = subprocess.Popen(
+                ["git", "cat-file", "--batch"],
+                cwd=cwd,
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+            )
+        except FileNotFoundError:
+            raise GitError("git not found on system PATH")
+
+    def read(self, obj: str) -> Optional[bytes]:
+        """Content of obj (a SHA-1 or any rev:path name), None if missing."""
+        self._proc.stdin.write(obj.encode("utf-8") + b"\n")
+        self._proc.stdin.flush()
+        header = self._proc.stdout.readline()
+        if not header:
+            raise GitError("git cat-file exited unexpectedly")
+        parts = header.split()
+        if len(parts) != 3:
+            return None  # "<obj> missing" / "ambiguous"
+        size = int(parts[2])
+        data = self._proc.stdout.read(size)
+        self._proc.stdout.read(1)  # trailing LF
+        return data
+
+    def close(self):
+        if self._proc.poll() is None:
+            self._proc.stdin.close()
+            self._proc.wait()
+
+    def __enter__(self) -> "CatFileBatch":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
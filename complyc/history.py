@@ -0,0 +1,205 @@
+"""
+history.py – Compliance trend over a commit range (`complyc history`)
+
+Walks the first-parent history of a range, oldest commit first, and reports
+per commit how many violations the files had, by severity and by rule.
+
+Nothing is checked out: every commit is read as a GitSnapshot, all through
+one `git cat-file --batch` process. Per-file results are keyed by blob id
+(the same ResultCache as --git-rev), and most files do not change between
+neighbouring commits, so every distinct file version is analyzed exactly
+once; each commit's counts are then summed from those per-blob results.
+A second run over an overlapping range only analyzes the new blobs.
+
+Output is JSON (one record per commit) or, for a .csv output path, a wide
+CSV with one row per commit and one column per severity and rule.
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import json
+import shutil
+import tempfile
+from collections import Counter
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+from . import gitutil
+from .cache import ResultCache, result_key, rules_fingerprint
+from .gitsnapshot import GitSnapshot, snapshot_result
+from .loader import load_rules
+from .main import resolve_use_gcc
+
+# Per-blob summary: (violations by rule, violations by severity, parse failed)
+BlobCounts = Tuple[Counter, Counter, bool]
+
+
+def _counts(violations) -> BlobCounts:
+    by_rule: Counter = Counter()
+    by_severity: Counter = Counter()
+    for v in violations:
+        by_rule[v.rule_id] += 1
+        by_severity[v.severity or "unspecified"] += 1
+    return by_rule, by_severity, False
+
+
+def walk_history(
+    commits: Sequence[Tuple[str, str, str]],
+    specs: Sequence[str],
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    cache_dir: Optional[str],
+    includes: Optional[Sequence[str]] = None,
+    excludes: Optional[Sequence[str]] = None,
+) -> Tuple[List[Dict[str, Any]], Dict[str, int]]:
+    """Return (one record per commit, run statistics)."""
+    rules_fp = rules_fingerprint(rules, use_gcc)
+    cache = ResultCache(cache_dir) if cache_dir else None
+    memo: Dict[str, BlobCounts] = {}      # result key -> counts, for this walk
+    include_cache: Dict[str, List[str]] = {}
+    analyzed = 0
+    records = []
+
+    top = gitutil.git_toplevel()
+    with gitutil.CatFileBatch(cwd=top) as batch:
+        for sha, date, subject in commits:
+            snapshot = GitSnapshot(sha, batch=batch, include_cache=include_cache)
+            # A fresh mirror per commit, so no header of another revision leaks in
+            mirror = tempfile.mkdtemp(prefix="complyc-history-") if use_gcc else None
+            by_rule: Counter = Counter()
+            by_severity: Counter = Counter()
+            paths = snapshot.select(specs, includes=includes, excludes=excludes)
+            new_blobs = errors = 0
+            try:
+                for path in paths:
+                    rule_counts, sev_counts, failed, fresh = _blob_counts(
+                        snapshot, path, rules, rules_fp, use_gcc, cache, mirror, memo
+                    )
+                    new_blobs += fresh
+                    errors += failed
+                    by_rule.update(rule_counts)
+                    by_severity.update(sev_counts)
+            finally:
+                if mirror:
+                    shutil.rmtree(mirror, ignore_errors=True)
+            analyzed += new_blobs
+
+            record = {
+                "commit": sha,
+                "date": date,
+                "subject": subject,
+                "files": len(paths),
+                "violations": sum(by_severity.values()),
+                "parse_errors": errors,
+                "by_severity": dict(sorted(by_severity.items())),
+                "by_rule": dict(sorted(by_rule.items())),
+            }
+            records.append(record)
+            print(f"[ComplyC] {sha[:10]} {date[:10]}: {record['files']} file(s), "
+                  f"{record['violations']} violation(s), {new_blobs} new blob(s) analyzed")
+
+    stats = {"commits": len(records), "distinct_results": len(memo), "analyzed": analyzed}
+    return records, stats
+
+
+def _blob_counts(snapshot, path, rules, rules_fp, use_gcc, cache, mirror, memo):
+    """(by rule, by severity, failed, freshly analyzed) for one path of a commit."""
+    deps = [snapshot.blobs[h] for h in snapshot.include_closure(path)] if use_gcc else []
+    key = result_key(rules_fp, snapshot.blobs[path], deps)
+    known = memo.get(key)
+    if known is not None:
+        return (*known, False)
+    try:
+        _key, violations, _metrics, fresh = snapshot_result(
+            snapshot, path, rules, rules_fp, use_gcc, cache, mirror
+        )
+    except Exception as e:
+        # Old revisions may not parse; count it and keep walking
+        print(f"[ComplyC] WARNING: {path} @ {snapshot.rev[:10]}: {e}")
+        memo[key] = (Counter(), Counter(), True)
+        return (*memo[key], True)
+    memo[key] = _counts(violations)
+    return (*memo[key], fresh)
+
+
+# ---------- output ----------
+
+def write_history_json(records, stats, outfile: str, rev_range: str):
+    data = {"range": rev_range, "stats": stats, "commits": records}
+    with open(outfile, "w", encoding="utf-8") as f:
+        json.dump(data, f, indent=2)
+
+
+def write_history_csv(records, outfile: str):
+    severities = sorted({s for r in records for s in r["by_severity"]})
+    rule_ids = sorted({rid for r in records for rid in r["by_rule"]})
+    with open(outfile, "w", encoding="utf-8", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(
+            ["commit", "date", "files", "violations", "parse_errors"]
+            + [f"severity:{s}" for s in severities]
+            + [f"rule:{rid}" for rid in rule_ids]
+        )
+        for r in records:
+            writer.writerow(
+                [r["commit"], r["date"], r["files"], r["violations"], r["parse_errors"]]
+                + [r["by_severity"].get(s, 0) for s in severities]
+                + [r["by_rule"].get(rid, 0) for rid in rule_ids]
+            )
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(
+        prog="complyc history",
+        description="Violation counts per commit over a git range (analyzes each file version once)",
+    )
+    parser.add_argument("--rules", required=True, help="Path to YAML rules file")
+    parser.add_argument(
+        "--range",
+        default="HEAD",
+        help="Commits to walk, any git log range (e.g. v1.0..main); first-parent line, default HEAD",
+    )
+    parser.add_argument(
+        "-n", "--max-count",
+        type=int,
+        default=500,
+        help="Only the most recent N commits of the range (0 = all, default 500)",
+    )
+    parser.add_argument("-o", "--output", default="complyc_history.json",
+                        help="Trend output: JSON, or CSV when the name ends in .csv")
+    parser.add_argument("--use-gcc", action="store_true", help="Force GCC (-E -P) preprocessing")
+    parser.add_argument("--no-gcc", action="store_true", help="Force the builtin preprocessor")
+    parser.add_argument("--cache-dir", default=".complyc_cache",
+                        help="Result cache shared with --git-rev/--changed-since runs")
+    parser.add_argument("--include", action="append", metavar="GLOB",
+                        help="File name pattern to pick up in directories (repeatable)")
+    parser.add_argument("--exclude", action="append", metavar="PATTERN",
+                        help="gitignore-style pattern to skip (repeatable)")
+    parser.add_argument("files", nargs="*", default=["."],
+                        help="Files, directories or globs to analyze in every commit (default .)")
+    args = parser.parse_args(argv)
+
+    style, rules = load_rules(args.rules, cache_dir=args.cache_dir)
+    use_gcc = resolve_use_gcc(style, args.use_gcc, args.no_gcc)
+
+    try:
+        commits = gitutil.log_commits(args.range, args.max_count)
+    except gitutil.GitError as e:
+        print(f"[ComplyC] ERROR: cannot list commits of {args.range}: {e}")
+        return 2
+    print(f"[ComplyC] History of {args.range}: {len(commits)} commit(s)")
+
+    records, stats = walk_history(
+        commits, args.files, rules, use_gcc, args.cache_dir,
+        includes=args.include, excludes=args.exclude,
+    )
+
+    if args.output.lower().endswith(".csv"):
+        write_history_csv(records, args.output)
+    else:
+        write_history_json(records, stats, args.output, args.range)
+    print(f"[ComplyC] {stats['commits']} commit(s), {stats['distinct_results']} distinct file "
+          f"version(s), {stats['analyzed']} analyzed (rest from cache)")
+    print(f"[ComplyC] History written to {args.output}")
+    return 0
@@ -0,0 +1,380 @@
+"""
+htmlpages.py – Paginated, client-side rendered HTML report (`--html-dir`)
+
+The single-page HTML report renders every violation as a table row, which
+browsers cannot cope with for very large runs. `--html-dir DIR` writes a
+small site instead:
+
+    DIR/index.html            summary, violations per rule and per severity
+    DIR/files.html            every file with its violation counts
+    DIR/rules/<RULE>.html     every violation of one rule
+    DIR/data/files-NNNN.js    the rows, in chunks of compact JSON
+    DIR/data/rule-<RULE>-NNNN.js
+    DIR/assets/report.{css,js}
+
+Pages are small shells: report.js loads only the chunks of the rows in view
+and renders just the visible rows (virtual scrolling), so a page stays fast
+whatever the number of violations. Chunks are JSON wrapped in a
+ComplyC.chunk(...) call, so the report also works when opened from disk
+(file://), where browsers refuse to fetch() local JSON.
+
+Rows are written as files complete and only one open chunk per rule is kept
+in memory. DIR/manifest.json records a hash of every file written; on
+regeneration files whose content did not change are not rewritten (their
+mtime stays, so syncing the report elsewhere only copies what changed), and
+files of the previous generation that are no longer produced are removed.
+Files are written to a temporary name and renamed into place, so a browser
+or sync job never reads a half-written page.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import html
+import json
+import os
+import re
+from typing import Any, Dict, Iterable, List, Optional
+
+MANIFEST = "manifest.json"
+RULE_CHUNK_ROWS = 2000
+FILE_CHUNK_ROWS = 5000
+SEVERITIES = ("critical", "major", "minor")
+
+
+def _slug(rule_id: str) -> str:
+    return re.sub(r"[^A-Za-z0-9_.-]", "_", rule_id) or "_"
+
+
+class _Chunks:
+    """Rows of one page, cut into chunk files of at most `size` rows."""
+
+    def __init__(self, site: "PagedHtmlReport", name: str, size: int, with_files: bool):
+        self.site = site
+        self.name = name
+        self.size = size
+        self.with_files = with_files
+        self.rows: List[list] = []
+        self.files: List[str] = []
+        self._file_index: Dict[str, int] = {}
+        self.chunks: List[List[Any]] = []  # [relative path, row count]
+        self.total = 0
+
+    def file_ref(self, path: str) -> int:
+        """Index of path in the current chunk's file table."""
+        index = self._file_index.get(path)
+        if index is None:
+            index = self._file_index[path] = len(self.files)
+            self.files.append(path)
+        return index
+
+    def add(self, row: list):
+        self.rows.append(row)
+        self.total += 1
+        if len(self.rows) >= self.size:
+            self.flush()
+
+    def flush(self):
+        if not self.rows:
+            return
+        rel = f"data/{self.name}-{len(self.chunks) + 1:04d}.js"
+        data: Dict[str, Any] = {"rows": self.rows}
+        if self.with_files:
+            data["files"] = self.files
+        payload = json.dumps(data, separators=(",", ":"), ensure_ascii=False)
+        self.site.write(rel, f"ComplyC.chunk({json.dumps(rel)},{payload});\n")
+        self.chunks.append([rel, len(self.rows)])
+        self.rows, self.files, self._file_index = [], [], {}
+
+
+class PagedHtmlReport:
+    def __init__(self, directory: str, rules: List[Dict[str, Any]]):
+        self.directory = directory
+        self.rules = {rule["id"]: rule for rule in rules}
+        self.rule_order = [rule["id"] for rule in rules]
+        self.by_rule: Dict[str, _Chunks] = {}
+        self.slugs: Dict[str, str] = {}
+        self.file_rows = _Chunks(self, "files", FILE_CHUNK_ROWS, with_files=False)
+        self.by_severity: Dict[str, int] = {}
+        self.total_violations = 0
+
+        try:
+            with open(os.path.join(directory, MANIFEST), "r", encoding="utf-8") as f:
+                self.previous: Dict[str, str] = json.load(f)
+        except (OSError, ValueError):
+            self.previous = {}
+        self.manifest: Dict[str, str] = {}
+        self.written = 0
+        self.unchanged = 0
+
+    # ---------- output ----------
+
+    def write(self, rel: str, text: str):
+        """Write DIR/rel unless the previous generation wrote the same content."""
+        data = text.encode("utf-8")
+        digest = hashlib.sha1(data).hexdigest()
+        self.manifest[rel] = digest
+        path = os.path.join(self.directory, rel)
+        if self.previous.get(rel) == digest and os.path.isfile(path):
+            self.unchanged += 1
+            return
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        tmp = f"{path}.{os.getpid()}.tmp"
+        try:
+            with open(tmp, "wb") as f:
+                f.write(data)
+            os.replace(tmp, path)
+        except BaseException:
+            try:
+                os.remove(tmp)
+            except OSError:
+                pass
+            raise
+        self.written += 1
+
+    def slug(self, rule_id: str) -> str:
+        """File-name stem of a rule, unique among the rules of this report."""
+        slug = self.slugs.get(rule_id)
+        if slug is None:
+            # Case-insensitive: the site may live on such a file system
+            base = slug = _slug(rule_id)
+            taken = {t.lower() for t in self.slugs.values()}
+            n = 2
+            while slug.lower() in taken:
+                slug = f"{base}-{n}"
+                n += 1
+            self.slugs[rule_id] = slug
+        return slug
+
+    # ---------- rows ----------
+
+    def add(self, path: str, violations: Iterable[Any]):
+        counts: Dict[str, int] = {}
+        total = 0
+        for v in violations:
+            chunks = self.by_rule.get(v.rule_id)
+            if chunks is None:
+                chunks = self.by_rule[v.rule_id] = _Chunks(self, f"rule-{self.slug(v.rule_id)}", RULE_CHUNK_ROWS,
+                                                           with_files=True)
+            chunks.add([chunks.file_ref(path), v.line, v.message])
+            sev = (v.severity or "unspecified").lower()
+            counts[sev] = counts.get(sev, 0) + 1
+            self.by_severity[sev] = self.by_severity.get(sev, 0) + 1
+            total += 1
+        self.total_violations += total
+        self.file_rows.add([path, total] + [counts.get(sev, 0) for sev in SEVERITIES])
+
+    # ---------- pages ----------
+
+    def _page(self, title: str, prefix: str, body: str, meta: Optional[Dict[str, Any]] = None) -> str:
+        parts = [
+            "<!DOCTYPE html>",
+            "<html><head><meta charset='UTF-8'>",
+            f"<title>{html.escape(title)}</title>",
+            f"<link rel='stylesheet' href='{prefix}assets/report.css'>",
+            f"<script src='{prefix}assets/report.js'></script>",
+            "</head><body>",
+            f"<p class='nav'><a href='{prefix}index.html'>Summary</a> &middot; "
+            f"<a href='{prefix}files.html'>Files</a></p>",
+            f"<h1>{html.escape(title)}</h1>",
+            body,
+        ]
+        if meta is not None:
+            parts.append("<div id='rows' class='rows'></div>")
+            parts.append(f"<script>ComplyC.page({json.dumps(meta, ensure_ascii=False)});</script>")
+        parts.append("</body></html>\n")
+        return "\n".join(parts)
+
+    def _rule_page(self, rule_id: str, chunks: _Chunks):
+        rule = self.rules.get(rule_id, {})
+        info = []
+        for label, key in (("Title", "title"), ("Severity", "severity"), ("Guidance", "guidance"),
+                           ("Reference", "reference")):
+            if rule.get(key):
+                info.append(f"<tr><th>{label}</th><td>{html.escape(str(rule[key]))}</td></tr>")
+        info.append(f"<tr><th>Violations</th><td>{chunks.total}</td></tr>")
+        body = "<table class='summary-table'>" + "".join(info) + "</table>"
+        meta = {
+            "base": "../",
+            "columns": [{"title": "File", "ref": "files"}, {"title": "Line"}, {"title": "Message"}],
+            "chunks": chunks.chunks,
+            "total": chunks.total,
+        }
+        self.write(f"rules/{self.slug(rule_id)}.html", self._page(f"Rule {rule_id}", "../", body, meta))
+
+    def _index(self, summary_rows: List[str], shard_info, sample_info) -> str:
+        rows = list(summary_rows)
+        if shard_info:
+            rows.append("<tr><th>Shard</th><td>{}/{} ({} of {} files)</td></tr>".format(
+                shard_info["index"], shard_info["count"], self.file_rows.total, shard_info["total_files"]))
+        if sample_info:
+            est = sample_info["estimated_violations"]
+            rows.append("<tr><th>Sample</th><td>{} of {} files; estimated {:.0f} violations "
+                        "({:.0%} CI {:.0f}&ndash;{:.0f})</td></tr>".format(
+                            sample_info["analyzed"], sample_info["population"], est["total"],
+                            sample_info["confidence"], est["low"], est["high"]))
+        body = ["<h2>Summary</h2>", "<table class='summary-table'>", *rows, "</table>"]
+
+        body.append("<h2>Violations by Rule</h2>")
+        body.append("<table class='summary-table'><tr><th>Rule</th><th>Title</th><th>Severity</th>"
+                    "<th>Violations</th></tr>")
+        ids = self.rule_order + sorted(set(self.by_rule) - set(self.rule_order))
+        for rule_id in ids:
+            rule = self.rules.get(rule_id, {})
+            chunks = self.by_rule.get(rule_id)
+            count = chunks.total if chunks else 0
+            name = html.escape(rule_id)
+            link = f"<a href='rules/{self.slug(rule_id)}.html'>{name}</a>" if count else name
+            sev = html.escape(str(rule.get("severity") or ""))
+            body.append(f"<tr><td>{link}</td><td>{html.escape(str(rule.get('title') or ''))}</td>"
+                        f"<td class='severity-{sev.lower()}'>{sev}</td><td>{count}</td></tr>")
+        body.append("</table>")
+        return self._page("ComplyC – Coding Style Report", "", "\n".join(body))
+
+    def close(
+        self,
+        run_info: Optional[Dict[str, Any]] = None,
+        shard_info: Optional[Dict[str, Any]] = None,
+        sample_info: Optional[Dict[str, Any]] = None,
+    ):
+        for chunks in self.by_rule.values():
+            chunks.flush()
+        self.file_rows.flush()
+
+        self.write("assets/report.css", REPORT_CSS)
+        self.write("assets/report.js", REPORT_JS)
+        for rule_id, chunks in self.by_rule.items():
+            self._rule_page(rule_id, chunks)
+
+        columns = [{"title": "File"}, {"title": "Violations"}] + [{"title": s.capitalize()} for s in SEVERITIES]
+        meta = {"base": "", "columns": columns, "chunks": self.file_rows.chunks, "total": self.file_rows.total}
+        self.write("files.html", self._page("Files", "", "", meta))
+
+        summary_rows = [
+            f"<tr><th>Total files</th><td><a href='files.html'>{self.file_rows.total}</a></td></tr>",
+            f"<tr><th>Total violations</th><td>{self.total_violations}</td></tr>",
+            "<tr><th>Violations by severity</th><td><ul>" + "".join(
+                f"<li class='severity-{html.escape(sev)}'>{html.escape(sev)}: {count}</li>"
+                for sev, count in self.by_severity.items()) + "</ul></td></tr>",
+        ]
+        if run_info:
+            util = ", ".join(f"{u:.0%}" for u in run_info["worker_utilization"])
+            summary_rows.append(f"<tr><th>Workers</th><td>{run_info['jobs']} (utilization: {util})</td></tr>")
+        self.write("index.html", self._index(summary_rows, shard_info, sample_info))
+
+        # Drop what the previous generation wrote and this one did not
+        for rel in set(self.previous) - set(self.manifest):
+            try:
+                os.remove(os.path.join(self.directory, rel))
+            except OSError:
+                pass
+        tmp = os.path.join(self.directory, f"{MANIFEST}.{os.getpid()}.tmp")
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(self.manifest, f, indent=0, sort_keys=True)
+        os.replace(tmp, os.path.join(self.directory, MANIFEST))
+        print(f"[ComplyC] HTML pages written to {os.path.join(self.directory, 'index.html')} "
+              f"({self.written} file(s) written, {self.unchanged} unchanged)")
+
+
+REPORT_CSS = """\
+body { font-family: Arial, sans-serif; margin: 20px; }
+h1, h2 { color: #333; }
+.nav { font-size: 14px; }
+.summary-table { border-collapse: collapse; margin-bottom: 20px; width: 100%; }
+.summary-table th, .summary-table td { border: 1px solid #ccc; padding: 6px 8px; font-size: 14px; text-align: left; }
+.severity-critical { color: #b30000; font-weight: bold; }
+.severity-major { color: #cc6600; font-weight: bold; }
+.severity-minor { color: #666600; }
+.rows { height: 75vh; overflow-y: auto; position: relative; border: 1px solid #ccc; font-size: 14px; }
+.row { position: absolute; left: 0; right: 0; height: 24px; line-height: 24px; display: flex;
+       border-bottom: 1px solid #eee; white-space: nowrap; }
+.row.head { position: sticky; top: 0; background: #f2f2f2; font-weight: bold; z-index: 1; }
+.row span { padding: 0 8px; overflow: hidden; text-overflow: ellipsis; flex: 0 0 90px; }
+.row span:first-child { flex: 0 0 35%; }
+.row span:last-child { flex: 1 1 auto; }
+.loading { color: #999; }
+"""
+
+REPORT_JS = """\
+// Virtual scrolling over rows stored in ComplyC.chunk(...) data files
+var ComplyC = (function () {
+  var ROW = 24, meta, box, spacer, starts = [], loaded = {}, requested = {};
+
+  function chunkOf(row) {
+    var lo = 0, hi = starts.length - 1;
+    while (lo < hi) {
+      var mid = (lo + hi + 1) >> 1;
+      if (starts[mid] <= row) lo = mid; else hi = mid - 1;
+    }
+    return lo;
+  }
+
+  function request(i) {
+    if (requested[i]) return;
+    requested[i] = true;
+    var s = document.createElement("script");
+    s.src = meta.base + meta.chunks[i][0];
+    document.head.appendChild(s);
+  }
+
+  function cells(i, row) {
+    var data = loaded[meta.chunks[i][0]], r = data.rows[row - starts[i]];
+    return meta.columns.map(function (c, k) {
+      return c.ref ? data[c.ref][r[k]] : (r[k] === null ? "?" : String(r[k]));
+    });
+  }
+
+  function render() {
+    var first = Math.max(0, Math.floor(box.scrollTop / ROW) - 10);
+    var last = Math.min(meta.total, Math.ceil((box.scrollTop + box.clientHeight) / ROW) + 10);
+    var frag = document.createDocumentFragment();
+    for (var row = first; row < last; row++) {
+      var i = chunkOf(row), div = document.createElement("div");
+      div.className = "row";
+      div.style.top = ((row + 1) * ROW) + "px";
+      if (loaded[meta.chunks[i][0]]) {
+        cells(i, row).forEach(function (text) {
+          var span = document.createElement("span");
+          span.textContent = text;
+          span.title = text;
+          div.appendChild(span);
+        });
+      } else {
+        div.className += " loading";
+        div.textContent = "loading\\u2026";
+        request(i);
+      }
+      frag.appendChild(div);
+    }
+    box.replaceChildren(box.firstChild, spacer, frag);
+  }
+
+  function page(m) {
+    meta = m;
+    box = document.getElementById("rows");
+    var total = 0;
+    meta.chunks.forEach(function (c) { starts.push(total); total += c[1]; });
+    var head = document.createElement("div");
+    head.className = "row head";
+    meta.columns.forEach(function (c) {
+      var span = document.createElement("span");
+      span.textContent = c.title;
+      head.appendChild(span);
+    });
+    spacer = document.createElement("div");
+    spacer.style.height = ((meta.total + 1) * ROW) + "px";
+    box.appendChild(head);
+    box.appendChild(spacer);
+    if (!meta.total) { box.appendChild(document.createTextNode("No rows \\u2705")); return; }
+    box.addEventListener("scroll", function () { window.requestAnimationFrame(render); });
+    render();
+  }
+
+  function chunk(name, data) {
+    loaded[name] = data;
+    if (meta) render();
+  }
+
+  return { page: page, chunk: chunk };
+})();
+"""
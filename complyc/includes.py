@@ -0,0 +1,145 @@
+"""
+includes.py – Cached #include dependency graph for ComplyC
+
+Records the quoted #include directives of every known source/header file and
+resolves them to files of the same project (relative to the including file,
+or by a unique basename match among known headers, which covers the usual
+-I include directories). The raw directive list of each file is cached by
+(mtime, size) so rebuilding the graph only re-reads files that changed.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import re
+from collections import defaultdict
+from typing import Dict, Iterable, List, Optional, Set
+
+
+INCLUDE_RE = re.compile(r'^\s*#\s*include\s*"([^"]+)"', re.MULTILINE)
+
+
+def scan_includes(path: str) -> List[str]:
+    """Return the quoted #include targets of a file, in order."""
+    try:
+        with open(path, "r", encoding="utf-8", errors="replace") as f:
+            return INCLUDE_RE.findall(f.read())
+    except OSError:
+        return []
+
+
+def include_closure(path: str) -> Set[str]:
+    """
+    Quoted includes of path resolvable relative to the including file,
+    followed transitively. A cheap, graph-less approximation used where no
+    project file list is at hand (e.g. the daemon's result memo).
+    """
+    seen: Set[str] = set()
+    stack = [path]
+    while stack:
+        cur = stack.pop()
+        base_dir = os.path.dirname(cur)
+        for inc in scan_includes(cur):
+            candidate = os.path.normpath(os.path.join(base_dir, inc))
+            if candidate not in seen and os.path.isfile(candidate):
+                seen.add(candidate)
+                stack.append(candidate)
+    return seen
+
+
+class IncludeGraph:
+    """Forward/reverse include edges between project files."""
+
+    FILENAME = "includes.json"
+
+    def __init__(self, cache_dir: Optional[str] = None):
+        self.path = os.path.join(cache_dir, self.FILENAME) if cache_dir else None
+        self._raw: Dict[str, Dict] = {}
+        self.edges: Dict[str, Set[str]] = {}
+        self.reverse: Dict[str, Set[str]] = defaultdict(set)
+        self.known: Set[str] = set()
+        self.by_basename: Dict[str, List[str]] = defaultdict(list)
+        if self.path and os.path.isfile(self.path):
+            try:
+                with open(self.path, "r", encoding="utf-8") as f:
+                    self._raw = json.load(f)
+            except (OSError, ValueError):
+                self._raw = {}
+
+    def _raw_includes(self, path: str) -> List[str]:
+        try:
+            st = os.stat(path)
+        except OSError:
+            return []
+        entry = self._raw.get(path)
+        if entry and entry["mtime_ns"] == st.st_mtime_ns and entry["size"] == st.st_size:
+            return entry["includes"]
+        includes = scan_includes(path)
+        self._raw[path] = {"mtime_ns": st.st_mtime_ns, "size": st.st_size, "includes": includes}
+        return includes
+
+    def build(self, files: Iterable[str]):
+        """(Re)build the edges for the given set of project files."""
+        files = list(files)
+        self.known = set(files)
+        self.by_basename = defaultdict(list)
+        for f in files:
+            self.by_basename[os.path.basename(f)].append(f)
+
+        self.edges = {}
+        self.reverse = defaultdict(set)
+        for f in files:
+            self.update_file(f)
+
+    def update_file(self, f: str):
+        """Re-resolve the includes of one already known file (e.g. after an edit)."""
+        for old in self.edges.get(f, ()):
+            self.reverse[old].discard(f)
+        resolved = set()
+        base_dir = os.path.dirname(f)
+        for inc in self._raw_includes(f):
+            candidate = os.path.normpath(os.path.join(base_dir, inc))
+            if candidate in self.known:
+                resolved.add(candidate)
+                continue
+            matches = self.by_basename.get(os.path.basename(inc), [])
+            if len(matches) == 1:
+                resolved.add(matches[0])
+        self.edges[f] = resolved
+        for target in resolved:
+            self.reverse[target].add(f)
+
+    def dependents(self, changed: Iterable[str]) -> Set[str]:
+        """All files that (transitively) include any of the changed files."""
+        result: Set[str] = set()
+        stack = list(changed)
+        while stack:
+            cur = stack.pop()
+            for parent in self.reverse.get(cur, ()):
+                if parent not in result:
+                    result.add(parent)
+                    stack.append(parent)
+        return result
+
+    def closure(self, path: str) -> Set[str]:
+        """All project files path (transitively) includes."""
+        result: Set[str] = set()
+        stack = [path]
+        while stack:
+            cur = stack.pop()
+            for child in self.edges.get(cur, ()):
+                if child not in result:
+                    result.add(child)
+                    stack.append(child)
+        result.discard(path)
+        return result
+
+    def save(self):
+        if not self.path:
+            return
+        os.makedirs(os.path.dirname(self.path), exist_ok=True)
+        tmp = self.path + ".tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(self._raw, f)
+        os.replace(tmp, self.path)
@@ -0,0 +1,149 @@
+"""
+incremental.py – Git-diff driven incremental analysis for ComplyC
+
+`--changed-since <ref>` analyzes only files that changed relative to ref plus
+everything that (transitively) includes them, and takes the results of all
+other files from the content-addressed result cache, so the merged output is
+still a full report. Unchanged files are looked up by the blob ids that
+`git ls-tree <ref>` already knows, so they are not even read.
+
+Cache misses (e.g. on the first incremental run) are analyzed as well and
+populate the cache for the next run.
+"""
+
+from __future__ import annotations
+
+import os
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Set, Tuple
+
+from . import gitutil
+from .cache import ResultCache, file_blob_hash, result_key, rules_fingerprint
+from .discovery import norm_path
+from .includes import IncludeGraph
+from .metrics import FunctionMetrics
+from .rule_engine import Violation
+from .runner import iter_analyze
+from .scheduler import RunStats, TimingStore
+
+HEADER_SUFFIXES = (".h",)
+
+
+class BlobIndex:
+    """Blob ids per file: taken from a git tree when known unchanged, else hashed."""
+
+    def __init__(self, tree_blobs: Optional[Dict[str, str]] = None, unchanged: Set[str] = frozenset()):
+        self.tree_blobs = tree_blobs or {}
+        self.unchanged = unchanged
+        self._memo: Dict[str, str] = {}
+
+    def get(self, key: str) -> Optional[str]:
+        blob = self._memo.get(key)
+        if blob is None:
+            if key in self.unchanged and key in self.tree_blobs:
+                blob = self.tree_blobs[key]
+            else:
+                try:
+                    blob = file_blob_hash(key)
+                except OSError:
+                    return None
+            self._memo[key] = blob
+        return blob
+
+
+def project_headers(tree_blobs: Dict[str, str], changed: Set[str], sources: Set[str]) -> Set[str]:
+    """
+    Headers the include graph is built over: every header tracked at ref or
+    changed since (untracked ones included), plus the headers next to the
+    analyzed files. The analyzed files alone (e.g. `src/*.c`) would leave a
+    changed header without the edges to the files that include it.
+    """
+    headers = {p for p in tree_blobs.keys() | changed if p.endswith(HEADER_SUFFIXES)}
+    for d in {os.path.dirname(p) or "." for p in sources}:
+        try:
+            names = os.listdir(d)
+        except OSError:
+            continue
+        headers.update(norm_path(os.path.join(d, n)) for n in names if n.endswith(HEADER_SUFFIXES))
+    return {h for h in headers if os.path.isfile(h)}
+
+
+def cache_key_for(
+    key: str,
+    rules_fp: str,
+    blobs: BlobIndex,
+    graph: Optional[IncludeGraph],
+    use_gcc: bool,
+) -> Optional[str]:
+    """Result-cache key of one file (GCC mode also covers its header closure)."""
+    blob = blobs.get(key)
+    if blob is None:
+        return None
+    deps = []
+    if use_gcc and graph is not None:
+        deps = [b for b in (blobs.get(h) for h in graph.closure(key)) if b]
+    return result_key(rules_fp, blob, deps)
+
+
+def iter_changed_since(
+    paths: Iterable[str],
+    ref: str,
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    cache_dir: str,
+    jobs: int = 1,
+    want_metrics: bool = False,
+    timings: Optional[TimingStore] = None,
+    stats: Optional[RunStats] = None,
+    jobserver=None,
+) -> Iterator[Tuple[str, List[Violation], Optional[List[FunctionMetrics]]]]:
+    """Yield (path, violations, metrics) for all paths, in input order."""
+    paths = list(paths)
+    keys = {p: norm_path(p) for p in paths}
+    known = set(keys.values())
+
+    try:
+        changed = {norm_path(p) for p in gitutil.changed_files(ref)}
+        tree_blobs = gitutil.ls_tree(ref)
+    except gitutil.GitError as e:
+        print(f"[ComplyC] ERROR: --changed-since {ref}: {e}")
+        raise SystemExit(2)
+
+    graph = IncludeGraph(cache_dir)
+    graph.build(known | project_headers(tree_blobs, changed, known))
+    affected = (changed & known) | (graph.dependents(changed) & known)
+
+    blobs = BlobIndex(tree_blobs, unchanged=known - changed)
+    rules_fp = rules_fingerprint(rules, use_gcc)
+    cache = ResultCache(cache_dir)
+
+    cached: Dict[str, Tuple[List[Violation], Optional[List[FunctionMetrics]]]] = {}
+    to_analyze: List[str] = []
+    for p in paths:
+        if keys[p] not in affected:
+            ck = cache_key_for(keys[p], rules_fp, blobs, graph, use_gcc)
+            hit = cache.get(ck, p, want_metrics) if ck else None
+            if hit is not None:
+                cached[p] = hit
+                continue
+        to_analyze.append(p)
+
+    print(f"[ComplyC] Changed since {ref}: {len(changed & known)} file(s), "
+          f"{len(affected - (changed & known))} dependent(s); "
+          f"analyzing {len(to_analyze)}, {len(cached)} from cache")
+
+    analyzed = iter_analyze(
+        to_analyze, rules, use_gcc, jobs=jobs, want_metrics=want_metrics,
+        timings=timings, stats=stats, jobserver=jobserver,
+    )
+    for p in paths:
+        if p in cached:
+            violations, metrics = cached.pop(p)
+            yield p, violations, metrics
+            continue
+        path, violations, metrics = next(analyzed)
+        ck = cache_key_for(keys[path], rules_fp, blobs, graph, use_gcc)
+        if ck:
+            cache.put(ck, violations, metrics)
+        yield path, violations, metrics
+
+    graph.save()
@@ -0,0 +1,157 @@
+"""
+jobserver.py – GNU make jobserver client
+
+When complyc runs from a recipe of `make -jN`, make passes a jobserver in
+MAKEFLAGS: a pipe (`--jobserver-auth=R,W`, older makes `--jobserver-fds`)
+or a named fifo (`--jobserver-auth=fifo:PATH`, make 4.4+) holding one byte
+per free job slot. Every process of the build owns one implicit slot; each
+additional concurrent process must first read a token byte and write the
+same byte back when done. Honouring this keeps complyc within make's global
+-j budget instead of adding its own -j on top.
+
+Used by
+    - the -j scheduler: worker 0 runs on the implicit slot, every other
+      worker only receives files while it holds a token (taken whenever one
+      is free, returned as soon as the worker runs out of work),
+    - the --pipeline preprocess threads: every concurrent gcc run holds a
+      token (the implicit slot covers complyc itself).
+
+Tokens are returned in `finally` blocks; a client that leaks them shrinks
+the whole build's parallelism.
+"""
+
+from __future__ import annotations
+
+import os
+import select
+import shlex
+import threading
+from contextlib import contextmanager
+from typing import List, Optional, Tuple
+
+
+def parse_makeflags(makeflags: str) -> Optional[Tuple[str, str]]:
+    """
+    Return ("fifo", path) or ("fds", "R,W") from a MAKEFLAGS value, None if
+    there is no jobserver. Only the options part (before " -- ") is looked
+    at, and the last --jobserver-auth wins, as in make.
+    """
+    try:
+        words = shlex.split(makeflags)
+    except ValueError:
+        words = makeflags.split()
+    auth = None
+    for word in words:
+        if word == "--":
+            break
+        for prefix in ("--jobserver-auth=", "--jobserver-fds="):
+            if word.startswith(prefix):
+                auth = word[len(prefix):]
+    if not auth:
+        return None
+    if auth.startswith("fifo:"):
+        return "fifo", auth[len("fifo:"):]
+    return "fds", auth
+
+
+class Jobserver:
+    """Token source shared by all threads of this process."""
+
+    def __init__(self, read_fd: int, write_fd: int, description: str, owns_write: bool = False):
+        self._read_fd = read_fd     # our own non-blocking open file description
+        self._write_fd = write_fd
+        self._owns_write = owns_write
+        self.description = description
+        self._lock = threading.Lock()
+        self.held: List[bytes] = []
+        self.peak = 0  # most tokens held at once
+
+    @classmethod
+    def from_environ(cls, environ=None) -> Optional["Jobserver"]:
+        """
+        The jobserver of the calling make, None outside make or without -j.
+
+        Raises OSError if MAKEFLAGS names a jobserver this process cannot
+        use (e.g. the recipe is not marked with '+', so make closed the fds).
+        """
+        environ = os.environ if environ is None else environ
+        parsed = parse_makeflags(environ.get("MAKEFLAGS", ""))
+        if parsed is None:
+            return None
+        kind, auth = parsed
+        if kind == "fifo":
+            read_fd = os.open(auth, os.O_RDONLY | os.O_NONBLOCK)
+            write_fd = os.open(auth, os.O_WRONLY)
+            return cls(read_fd, write_fd, f"fifo {auth}", owns_write=True)
+
+        try:
+            r, w = (int(x) for x in auth.split(",", 1))
+        except ValueError:
+            raise OSError(f"malformed --jobserver-auth value {auth!r}")
+        if r < 0 or w < 0:
+            raise OSError("make disabled the jobserver for this command")
+        os.fstat(r)
+        os.fstat(w)
+        # A fresh open of the pipe gets a description of our own, so it can be
+        # non-blocking without affecting make or the other jobs sharing fd r.
+        try:
+            read_fd = os.open(f"/proc/self/fd/{r}", os.O_RDONLY | os.O_NONBLOCK)
+        except OSError:
+            read_fd = os.dup(r)  # no /proc: reads may block briefly on a lost race
+        return cls(read_fd, w, f"fds {r},{w}")
+
+    @property
+    def peak_jobs(self) -> int:
+        """Most job slots used at once: the tokens plus our implicit slot."""
+        return self.peak + 1
+
+    # ---------- tokens ----------
+
+    def try_acquire(self) -> Optional[bytes]:
+        """A token if one is free right now, else None."""
+        ready, _, _ = select.select([self._read_fd], [], [], 0)
+        if not ready:
+            return None
+        try:
+            token = os.read(self._read_fd, 1)
+        except (BlockingIOError, InterruptedError):
+            return None  # another job was faster
+        if not token:
+            return None
+        with self._lock:
+            self.held.append(token)
+            self.peak = max(self.peak, len(self.held))
+        return token
+
+    def acquire(self, poll_seconds: float = 0.1) -> bytes:
+        """Wait for a token."""
+        while True:
+            token = self.try_acquire()
+            if token is not None:
+                return token
+            select.select([self._read_fd], [], [], poll_seconds)
+
+    def release(self, token: bytes):
+        with self._lock:
+            self.held.remove(token)
+        os.write(self._write_fd, token)
+
+    @contextmanager
+    def token(self):
+        """Hold one token for the duration of the block (e.g. one gcc run)."""
+        token = self.acquire()
+        try:
+            yield
+        finally:
+            self.release(token)
+
+    def close(self):
+        """Return anything still held and drop our file descriptors."""
+        with self._lock:
+            leftover, self.held = self.held, []
+        for token in leftover:
+            os.write(self._write_fd, token)
+        os.close(self._read_fd)
+        if self._owns_write:
+            os.close(self._write_fd)
+
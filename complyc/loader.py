@@ -1,8 +1,71 @@
-import yaml
+import marshal
+import os
+import sys
+import zlib
 
-def load_rules(path: str):
-    with open(path, "r", encoding="utf-8") as f:
-        data = yaml.safe_load(f)
-    style = data.get("style", {})
-    rules = data.get("rules", [])
+# Parsed rule files: abspath -> ((mtime_ns, size), style, rules).
+# Long-lived processes (daemon) get hot reload for free: an edited YAML file
+# has a new signature and is parsed again on the next call.
+_LOADED = {}
+
+# Precompiled rule bundles: the parsed YAML as a marshal blob in the cache
+# dir, so short runs (pre-commit hooks) skip importing and running yaml.
+# marshal data is interpreter-specific, hence the version in the header.
+BUNDLE_VERSION = 1
+BUNDLE_DIR = "rules"
+
+
+def _bundle_path(cache_dir: str, key: str) -> str:
+    # crc32 only names the file; the header check guards against collisions
+    digest = format(zlib.crc32(key.encode("utf-8")), "08x")
+    return os.path.join(cache_dir, BUNDLE_DIR, digest + ".bundle")
+
+
+def _read_bundle(bundle_path: str, key: str, signature):
+    header = (BUNDLE_VERSION, sys.version_info[:2], key, signature)
+    try:
+        with open(bundle_path, "rb") as f:
+            stored_header, style, rules = marshal.load(f)
+    except (OSError, EOFError, ValueError, TypeError):
+        return None
+    if tuple(stored_header) != header:
+        return None
+    return style, rules
+
+
+def _write_bundle(bundle_path: str, key: str, signature, style, rules):
+    header = (BUNDLE_VERSION, sys.version_info[:2], key, signature)
+    try:
+        os.makedirs(os.path.dirname(bundle_path), exist_ok=True)
+        tmp = f"{bundle_path}.{os.getpid()}.tmp"
+        with open(tmp, "wb") as f:
+            marshal.dump((header, style, rules), f)
+        os.replace(tmp, bundle_path)
+    except (OSError, ValueError):
+        pass  # only a cache
+
+
+def load_rules(path: str, cache_dir: str = None):
+    st = os.stat(path)
+    signature = (st.st_mtime_ns, st.st_size)
+    key = os.path.abspath(path)
+    cached = _LOADED.get(key)
+    if cached and cached[0] == signature:
+        return cached[1], cached[2]
+
+    bundle_path = _bundle_path(cache_dir, key) if cache_dir else None
+    bundled = _read_bundle(bundle_path, key, signature) if bundle_path else None
+    if bundled:
+        style, rules = bundled
+    else:
+        import yaml
+
+        with open(path, "r", encoding="utf-8") as f:
+            data = yaml.safe_load(f)
+        style = data.get("style", {})
+        rules = data.get("rules", [])
+        if bundle_path:
+            _write_bundle(bundle_path, key, signature, style, rules)
+
+    _LOADED[key] = (signature, style, rules)
     return style, rules
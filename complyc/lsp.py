@@ -0,0 +1,514 @@
+"""
+lsp.py – Language Server Protocol mode for ComplyC
+
+Publishes ComplyC violations as LSP diagnostics for open editor buffers,
+analyzed straight from memory (unsaved edits included) over stdio.
+
+Incremental analysis: each buffer is split into top-level chunks. Function
+definitions are parsed and checked one at a time and their results are
+cached by function text (lines stored relative to the function start), so an
+edit re-parses only the function it touches; functions that merely moved
+up or down reuse their results. Everything else (declarations, typedefs,
+globals, the file header) forms the "preamble", parsed once per change to it.
+Edits are debounced, and a result is only published if the buffer has not
+changed again in the meantime.
+
+Only the built-in preprocessor is used here (GCC needs the file on disk).
+
+Usage:
+    python -m complyc.lsp [--rules rules.yml] [--debounce-ms 100]
+
+The rules file can also be given by the client as initializationOptions
+{"rules": "path/to/rules.yml"} (relative to the workspace root). It is
+re-read automatically when it changes on disk.
+"""
+
+from __future__ import annotations
+
+import argparse
+import bisect
+import json
+import os
+import re
+import sys
+import threading
+import time
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Any, BinaryIO, Dict, List, Optional, Tuple
+from urllib.parse import unquote, urlparse
+
+from pycparser import c_ast
+
+from .loader import load_rules
+from .parser import (
+    get_parser,
+    inject_fake_typedefs,
+    line_marker,
+    preprocess_code_preserving_lines,
+)
+from .rule_engine import Violation, run_rules
+
+
+DEFAULT_DEBOUNCE_MS = 100
+
+# Function results kept across edits (all open documents together)
+MAX_CACHED_FUNCTIONS = 4096
+
+# LSP DiagnosticSeverity
+SEVERITY_LEVELS = {"critical": 1, "error": 1, "major": 2, "warning": 2, "minor": 3, "info": 3}
+HINT_SEVERITY = 3
+
+# JSON-RPC 2.0 error codes
+METHOD_NOT_FOUND = -32601
+INVALID_REQUEST = -32600
+
+
+# ============================================================
+#   Top-level chunking
+# ============================================================
+
+@dataclass
+class Chunk:
+    start: int          # character offsets into the preprocessed text
+    end: int
+    line: int           # 1-based first / last line
+    end_line: int
+    is_function: bool
+
+
+# String/char literals are skipped as a whole; only braces and ';' matter
+_TOKEN_RE = re.compile(r'"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\'|[{};]')
+
+
+def split_top_level(code: str) -> List[Chunk]:
+    """
+    Split preprocessed C code at top-level ';' and function-body braces.
+
+    A top-level '{' whose preceding chunk text ends in ')' opens a function
+    body; any other brace block (struct, enum, initializer) belongs to the
+    declaration that the next ';' terminates.
+    """
+    newlines = [i for i, ch in enumerate(code) if ch == "\n"]
+
+    def line_of(offset: int) -> int:
+        return bisect.bisect_right(newlines, offset - 1) + 1
+
+    chunks: List[Chunk] = []
+    start = 0
+    depth = 0
+    in_function = False
+
+    def close(end: int, is_function: bool):
+        nonlocal start
+        if code[start:end].strip():
+            # Leading whitespace belongs to no chunk
+            lead = len(code[start:end]) - len(code[start:end].lstrip())
+            first = start + lead
+            chunks.append(Chunk(first, end, line_of(first), line_of(end - 1), is_function))
+        start = end
+
+    for m in _TOKEN_RE.finditer(code):
+        tok = m.group(0)
+        if tok == "{":
+            if depth == 0:
+                in_function = code[start:m.start()].rstrip().endswith(")")
+            depth += 1
+        elif tok == "}":
+            depth = max(depth - 1, 0)
+            if depth == 0 and in_function:
+                in_function = False
+                close(m.end(), True)
+        elif tok == ";" and depth == 0:
+            close(m.end(), False)
+    close(len(code), False)
+    return chunks
+
+
+# ============================================================
+#   Incremental analysis
+# ============================================================
+
+@dataclass
+class AnalysisResult:
+    violations: List[Violation]
+    errors: List[Tuple[int, str]]   # (line, message) of syntax errors
+    functions: int = 0
+    reparsed: int = 0
+
+
+_PARSE_ERROR_RE = re.compile(r":(\d+)(?::\d+)?:\s*(.*)$", re.DOTALL)
+
+
+def _parse_error(exc: Exception, default_line: int = 1) -> Tuple[int, str]:
+    """(line, message) of a pycparser error; some errors carry no position."""
+    text = str(exc)
+    m = _PARSE_ERROR_RE.search(text)
+    if m:
+        return int(m.group(1)), f"Parse error: {m.group(2).strip()}"
+    return default_line, f"Parse error: {text.split(': ', 1)[-1]}"
+
+
+def _typedef_names(ast: c_ast.FileAST) -> Tuple[str, ...]:
+    return tuple(sorted({n.name for n in ast.ext if isinstance(n, c_ast.Typedef)}))
+
+
+class IncrementalAnalyzer:
+    """Per-function result reuse across successive versions of a buffer."""
+
+    def __init__(self, max_functions: int = MAX_CACHED_FUNCTIONS):
+        self.max_functions = max_functions
+        # (rules id, typedef names, function text) -> [(violation, relative line)]
+        self._functions: "OrderedDict[Tuple, List[Tuple[Violation, Optional[int]]]]" = OrderedDict()
+        # uri -> (preamble key, violations, typedef names, error)
+        self._preambles: Dict[str, Tuple] = {}
+
+    def forget(self, uri: str):
+        self._preambles.pop(uri, None)
+
+    def _parse(self, code: str, path: str) -> c_ast.FileAST:
+        return get_parser().parse(inject_fake_typedefs(code), filename=path)
+
+    def _preamble(self, uri, path, code, chunks, file_lines, rules):
+        # Function bodies are blanked (newlines kept), so every declaration
+        # keeps its line; the header lines are part of the key because the
+        # file-header check reads the raw text.
+        parts = []
+        pos = 0
+        for ch in chunks:
+            if ch.is_function:
+                parts.append(code[pos:ch.start])
+                parts.append("\n" * code.count("\n", ch.start, ch.end))
+                pos = ch.end
+        parts.append(code[pos:])
+        text = "".join(parts)
+        key = (id(rules), text, tuple(file_lines[:20]))
+
+        cached = self._preambles.get(uri)
+        if cached and cached[0] == key:
+            return cached[1], cached[2], cached[3]
+
+        try:
+            ast = self._parse(line_marker(1, path) + text, path)
+        except Exception as e:
+            result = ([], (), _parse_error(e))
+        else:
+            result = (run_rules(ast, rules, path, file_lines=file_lines), _typedef_names(ast), None)
+        self._preambles[uri] = (key,) + result
+        return result
+
+    def _function(self, path, code, chunk, typedefs, file_lines, rules):
+        text = code[chunk.start:chunk.end]
+        key = (id(rules), typedefs, text)
+        cached = self._functions.get(key)
+        if cached is not None:
+            self._functions.move_to_end(key)
+            return cached, False
+
+        # Buffer typedefs are stubbed out (their definition does not matter to
+        # the checks); the stub lines are numbered far away from real lines.
+        stubs = "".join(f"typedef int {name};\n" for name in typedefs)
+        unit = line_marker(1 << 30, path) + stubs + line_marker(chunk.line, path) + text
+        ast = self._parse(unit, path)
+        unit_rules = [r for r in rules if r.get("scope", "file") != "file"]
+        entries = [
+            (v, None if v.line is None else v.line - chunk.line)
+            for v in run_rules(ast, unit_rules, path, file_lines=file_lines)
+            if v.line is None or chunk.line <= v.line <= chunk.end_line
+        ]
+        self._functions[key] = entries
+        while len(self._functions) > self.max_functions:
+            self._functions.popitem(last=False)
+        return entries, True
+
+    def analyze(self, uri: str, path: str, source: str, rules: List[Dict[str, Any]]) -> AnalysisResult:
+        code = preprocess_code_preserving_lines(source)
+        file_lines = source.splitlines(keepends=True)
+        chunks = split_top_level(code)
+
+        violations, typedefs, error = self._preamble(uri, path, code, chunks, file_lines, rules)
+        result = AnalysisResult(list(violations), [error] if error else [])
+
+        for chunk in chunks:
+            if not chunk.is_function:
+                continue
+            result.functions += 1
+            try:
+                entries, reparsed = self._function(path, code, chunk, typedefs, file_lines, rules)
+            except Exception as e:
+                result.errors.append(_parse_error(e, chunk.line))
+                result.reparsed += 1
+                continue
+            result.reparsed += reparsed
+            for v, rel in entries:
+                line = None if rel is None else chunk.line + rel
+                result.violations.append(Violation(
+                    rule_id=v.rule_id,
+                    message=v.message,
+                    file=path,
+                    line=line,
+                    severity=v.severity,
+                    reference=v.reference,
+                ))
+        return result
+
+
+# ============================================================
+#   Diagnostics
+# ============================================================
+
+def _line_range(line: Optional[int], lines: List[str]) -> Dict[str, Any]:
+    idx = max((line or 1) - 1, 0)
+    text = lines[idx] if idx < len(lines) else ""
+    start = len(text) - len(text.lstrip())
+    return {
+        "start": {"line": idx, "character": start},
+        "end": {"line": idx, "character": len(text.rstrip("\r\n"))},
+    }
+
+
+def to_diagnostics(result: AnalysisResult, source: str) -> List[Dict[str, Any]]:
+    lines = source.splitlines()
+    diagnostics = []
+    for line, message in result.errors:
+        diagnostics.append({
+            "range": _line_range(line, lines),
+            "severity": 1,
+            "source": "complyc",
+            "message": message,
+        })
+    for v in sorted(result.violations, key=lambda v: (v.line or 0, v.rule_id)):
+        message = v.message
+        if v.reference:
+            message += f" ({v.reference})"
+        diagnostics.append({
+            "range": _line_range(v.line, lines),
+            "severity": SEVERITY_LEVELS.get((v.severity or "").lower(), HINT_SEVERITY),
+            "code": v.rule_id,
+            "source": "complyc",
+            "message": message,
+        })
+    return diagnostics
+
+
+def uri_to_path(uri: str) -> str:
+    parsed = urlparse(uri)
+    if parsed.scheme == "file":
+        return unquote(parsed.path)
+    return uri
+
+
+# ============================================================
+#   Server
+# ============================================================
+
+class LanguageServer:
+    """Minimal stdio LSP server: text sync in, publishDiagnostics out."""
+
+    def __init__(self, rules_path: Optional[str], debounce_ms: int = DEFAULT_DEBOUNCE_MS):
+        self.rules_path = rules_path
+        self.debounce = debounce_ms / 1000.0
+        self.root = os.getcwd()
+        self.documents: Dict[str, Tuple[int, str]] = {}   # uri -> (version, text)
+        self.timers: Dict[str, threading.Timer] = {}
+        self.analyzer = IncrementalAnalyzer()
+        self.analysis_lock = threading.Lock()
+        self.write_lock = threading.Lock()
+        self.shutdown_requested = False
+        self._rules_error_shown = False
+        self.out: BinaryIO = sys.stdout.buffer
+
+    # ---------- transport ----------
+
+    def send(self, message: Dict[str, Any]):
+        body = json.dumps(message).encode("utf-8")
+        with self.write_lock:
+            self.out.write(f"Content-Length: {len(body)}\r\n\r\n".encode("ascii") + body)
+            self.out.flush()
+
+    def notify(self, method: str, params: Dict[str, Any]):
+        self.send({"jsonrpc": "2.0", "method": method, "params": params})
+
+    def log(self, message: str, level: int = 4):
+        self.notify("window/logMessage", {"type": level, "message": f"[ComplyC] {message}"})
+
+    @staticmethod
+    def read_message(stream: BinaryIO) -> Optional[Dict[str, Any]]:
+        length = None
+        while True:
+            header = stream.readline()
+            if not header:
+                return None
+            header = header.strip()
+            if not header:
+                break
+            name, _, value = header.decode("ascii").partition(":")
+            if name.strip().lower() == "content-length":
+                length = int(value.strip())
+        if length is None:
+            return None
+        return json.loads(stream.read(length).decode("utf-8"))
+
+    def serve(self, stream: BinaryIO) -> int:
+        while True:
+            message = self.read_message(stream)
+            if message is None:
+                return 0 if self.shutdown_requested else 1
+            if message.get("method") == "exit":
+                return 0 if self.shutdown_requested else 1
+            self.dispatch(message)
+
+    def dispatch(self, message: Dict[str, Any]):
+        method = message.get("method")
+        req_id = message.get("id")
+        params = message.get("params") or {}
+        if method is None:
+            return  # a response to something we never ask
+        handler = getattr(self, "on_" + method.replace("/", "_").replace("$", "_"), None)
+        if handler is None:
+            if req_id is not None:
+                self.send({"jsonrpc": "2.0", "id": req_id,
+                           "error": {"code": METHOD_NOT_FOUND, "message": f"unknown method {method!r}"}})
+            return
+        try:
+            result = handler(params)
+        except Exception as e:
+            if req_id is not None:
+                self.send({"jsonrpc": "2.0", "id": req_id,
+                           "error": {"code": INVALID_REQUEST, "message": str(e)}})
+            else:
+                self.log(f"{method} failed: {e}", level=1)
+            return
+        if req_id is not None:
+            self.send({"jsonrpc": "2.0", "id": req_id, "result": result})
+
+    # ---------- lifecycle ----------
+
+    def on_initialize(self, params):
+        root_uri = params.get("rootUri")
+        if root_uri:
+            self.root = uri_to_path(root_uri)
+        elif params.get("rootPath"):
+            self.root = params["rootPath"]
+        options = params.get("initializationOptions") or {}
+        if options.get("rules"):
+            self.rules_path = options["rules"]
+        if self.rules_path and not os.path.isabs(self.rules_path):
+            self.rules_path = os.path.join(self.root, self.rules_path)
+        return {
+            "capabilities": {
+                "textDocumentSync": {"openClose": True, "change": 1, "save": {"includeText": False}},
+            },
+            "serverInfo": {"name": "complyc"},
+        }
+
+    def on_initialized(self, params):
+        return None
+
+    def on_shutdown(self, params):
+        self.shutdown_requested = True
+        for timer in self.timers.values():
+            timer.cancel()
+        return None
+
+    # ---------- documents ----------
+
+    def on_textDocument_didOpen(self, params):
+        doc = params["textDocument"]
+        self.documents[doc["uri"]] = (doc.get("version", 0), doc["text"])
+        self.analyze(doc["uri"])
+
+    def on_textDocument_didChange(self, params):
+        uri = params["textDocument"]["uri"]
+        changes = params.get("contentChanges") or []
+        if not changes:
+            return
+        # Full sync: the last change carries the whole buffer
+        self.documents[uri] = (params["textDocument"].get("version", 0), changes[-1]["text"])
+        self.schedule(uri)
+
+    def on_textDocument_didSave(self, params):
+        uri = params["textDocument"]["uri"]
+        if uri in self.documents:
+            self.schedule(uri, delay=0)
+
+    def on_textDocument_didClose(self, params):
+        uri = params["textDocument"]["uri"]
+        timer = self.timers.pop(uri, None)
+        if timer:
+            timer.cancel()
+        self.documents.pop(uri, None)
+        with self.analysis_lock:
+            self.analyzer.forget(uri)
+        self.notify("textDocument/publishDiagnostics", {"uri": uri, "diagnostics": []})
+
+    def on__cancelRequest(self, params):
+        return None
+
+    # ---------- analysis ----------
+
+    def schedule(self, uri: str, delay: Optional[float] = None):
+        old = self.timers.pop(uri, None)
+        if old:
+            old.cancel()
+        timer = threading.Timer(self.debounce if delay is None else delay, self.analyze, (uri,))
+        timer.daemon = True
+        self.timers[uri] = timer
+        timer.start()
+
+    def _rules(self) -> Optional[List[Dict[str, Any]]]:
+        if not self.rules_path:
+            if not self._rules_error_shown:
+                self._rules_error_shown = True
+                self.notify("window/showMessage", {
+                    "type": 1,
+                    "message": "ComplyC: no rules file configured (--rules or initializationOptions.rules)",
+                })
+            return None
+        try:
+            _style, rules = load_rules(self.rules_path)
+            return rules
+        except Exception as e:
+            self.log(f"Cannot load rules from {self.rules_path}: {e}", level=1)
+            return None
+
+    def analyze(self, uri: str):
+        with self.analysis_lock:
+            doc = self.documents.get(uri)
+            if doc is None:
+                return
+            version, text = doc
+            rules = self._rules()
+            if rules is None:
+                return
+            t0 = time.perf_counter()
+            result = self.analyzer.analyze(uri, uri_to_path(uri), text, rules)
+            elapsed = (time.perf_counter() - t0) * 1000
+            if self.documents.get(uri, (None,))[0] != version:
+                return  # edited again meanwhile; the pending timer will publish
+            self.notify("textDocument/publishDiagnostics", {
+                "uri": uri,
+                "version": version,
+                "diagnostics": to_diagnostics(result, text),
+            })
+            self.log(f"{uri}: {len(result.violations)} violation(s) in {elapsed:.0f} ms "
+                     f"({result.reparsed}/{result.functions} function(s) re-parsed)")
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="ComplyC language server (stdio)")
+    parser.add_argument("--rules", help="YAML rules file (or initializationOptions.rules)")
+    parser.add_argument(
+        "--debounce-ms",
+        type=int,
+        default=DEFAULT_DEBOUNCE_MS,
+        help=f"Delay after the last edit before re-analyzing (default {DEFAULT_DEBOUNCE_MS})",
+    )
+    parser.add_argument("--stdio", action="store_true", help="Accepted for editor compatibility (always stdio)")
+    args = parser.parse_args(argv)
+    server = LanguageServer(args.rules, args.debounce_ms)
+    return server.serve(sys.stdin.buffer)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,13 +1,25 @@
 import argparse
 import os
+import sys
 import glob
+import time
+import re
 from collections import Counter
 from datetime import datetime
+from typing import Any, Dict, List, Optional, Tuple
 
+from .console import print_file_result, print_summary_header, print_summary_footer, print_warnings
 from .loader import load_rules
-from .parser import parse_c_file
-from .rule_engine import run_rules
-from .reporters import write_json_report, write_html_report
+from .discovery import DEFAULT_INCLUDES, iter_sources
+from .sample import parse_sample_spec
+from .shard import parse_shard_spec
+
+# Everything else (parser backends, reporters, git/cache/watch support) is
+# imported where it is used, so a single-file run only loads what it needs.
+
+
+MAX_FILE_TAG_LEN = 100
+DEFAULT_CACHE_DIR = ".complyc_cache"
 
 
 def ensure_reports_dir() -> str:
@@ -38,16 +50,146 @@ def make_timestamp() -> str:
     return datetime.now().strftime("%Y%m%d_%H%M%S")
 
 
-def main():
+def resolve_report_paths(
+    inputs: List[str],
+    json_path: Optional[str],
+    html_path: Optional[str],
+    clean: bool = False,
+) -> Tuple[Optional[str], Optional[str]]:
+    """
+    Return the JSON/HTML report paths to write.
+
+    If neither was given, both default to timestamped files in reports/ named
+    after the inputs (files, directories or globs).
+    """
+    reports_dir = ensure_reports_dir()
+
+    if clean:
+        clean_reports_folder()
+
+    ts = make_timestamp()
+
+    # Build a short identifier from the inputs (files, directories or globs)
+    file_basenames = [
+        re.sub(r"[^A-Za-z0-9_.-]", "", os.path.splitext(os.path.basename(os.path.normpath(f)))[0]) or "src"
+        for f in inputs
+    ]
+
+    # If there is only one file, use its name. If multiple, join with "_And_"
+    if len(file_basenames) == 1:
+        file_tag = file_basenames[0]
+    else:
+        file_tag = "_And_".join(file_basenames)
+
+    # Keep report names within file-system limits for long input lists
+    if len(file_tag) > MAX_FILE_TAG_LEN:
+        file_tag = f"{file_basenames[0]}_And_{len(file_basenames) - 1}_more"
+
+    # If user didn't specify any paths, generate timestamped defaults with file names
+    if json_path is None and html_path is None:
+        json_path = os.path.join(reports_dir, f"complyc_report_{file_tag}_{ts}.json")
+        html_path = os.path.join(reports_dir, f"complyc_report_{file_tag}_{ts}.html")
+
+    return json_path, html_path
+
+
+def resolve_use_gcc(style: Dict[str, Any], force_gcc: bool, force_builtin: bool) -> bool:
+    """Decide the preprocessor: CLI override first, then the YAML 'preprocessor' key."""
+    if force_gcc:
+        return True
+    if force_builtin:
+        return False
+    return str((style or {}).get("preprocessor", "builtin")).lower() == "gcc"
+
+
+def select_shard(paths: List[str], index: int, count: int):
+    """Return (this shard's paths, "shard" report block) for --shard index/count."""
+    from .shard import assign_shards, partition_digest
+
+    shards = assign_shards(paths, count)
+    positions = [i for i, s in enumerate(shards) if s == index - 1]
+    info = {
+        "index": index,
+        "count": count,
+        "total_files": len(paths),
+        "partition": partition_digest(paths, shards),
+        "positions": positions,
+    }
+    return [paths[i] for i in positions], info
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    """CLI entry point; returns the process exit code (subcommands included)."""
+    argv = sys.argv[1:] if argv is None else argv
+    print_warnings()
+    if argv and argv[0] == "merge":
+        from .merge import main as merge_main
+        return merge_main(argv[1:])
+    if argv and argv[0] == "convert":
+        from .compact import main as convert_main
+        return convert_main(argv[1:])
+    if argv and argv[0] == "history":
+        from .history import main as history_main
+        return history_main(argv[1:])
+
     parser = argparse.ArgumentParser(description="ComplyC – Coding Style Checker")
     parser.add_argument("--rules", required=True, help="Path to YAML rules file")
     parser.add_argument("--json-report", help="Path to write JSON report (optional)")
     parser.add_argument("--html-report", help="Path to write HTML report (optional)")
+    parser.add_argument(
+        "--html-dir",
+        metavar="DIR",
+        help="Also write a paginated HTML report (index, per-rule and file pages rendered from "
+             "data chunks) for runs too large for a single page; unchanged files are not rewritten",
+    )
+    parser.add_argument(
+        "--sarif-report",
+        metavar="FILE",
+        help="Also write a SARIF 2.1.0 report (for code-scanning tools), streamed as files complete",
+    )
+    parser.add_argument(
+        "--format",
+        choices=("text", "ndjson"),
+        default="text",
+        help="Console stream format: human-readable text (default) or one JSON record per "
+             "violation/file plus progress and summary records, flushed per file",
+    )
+    parser.add_argument(
+        "--output",
+        metavar="FILE",
+        help="Write the --format ndjson stream to FILE instead of stdout",
+    )
+    parser.add_argument(
+        "--progress-interval",
+        type=float,
+        default=5.0,
+        metavar="SECONDS",
+        help="Seconds between --format ndjson progress records (default 5)",
+    )
+    parser.add_argument(
+        "--json-schema",
+        type=int,
+        choices=(1, 2),
+        default=1,
+        help="JSON report layout: 1 (default) or the compact 2 with rule and file tables "
+             "('convert' turns v2 back into v1); a .gz/.zst report name compresses either",
+    )
+    parser.add_argument(
+        "--json-summary",
+        metavar="FILE",
+        help="Also write the JSON report's summary (and run/sample blocks) to a small separate file",
+    )
     parser.add_argument(
         "--quiet",
         action="store_true",
         help="Suppress detailed per-file violation output (summary only)",
     )
+    parser.add_argument(
+        "--no-reports",
+        action="store_true",
+        help="Do not write the default timestamped reports (explicit --json-report/--html-report "
+             "are still written); e.g. for pre-commit hooks",
+    )
     parser.add_argument(
         "--clean-reports",
         action="store_true",
@@ -63,37 +205,452 @@ def main():
         action="store_true",
         help="Force use of builtin regex preprocessor (overrides YAML).",
     )
-    parser.add_argument("files", nargs="+", help="C source files to analyze")
-    args = parser.parse_args()
+    parser.add_argument(
+        "--metrics-csv",
+        help="Path to write per-function metrics as CSV (optional)",
+    )
+    parser.add_argument(
+        "--metrics-bin",
+        help="Path to write per-function metrics in columnar binary format (optional)",
+    )
+    parser.add_argument(
+        "-j", "--jobs",
+        type=int,
+        default=1,
+        help="Number of worker processes for file analysis (0 = all CPUs, default 1)",
+    )
+    parser.add_argument(
+        "--pipeline",
+        action="store_true",
+        help="Analyze in-process as overlapped stages (read, preprocess, parse+rules, emit) "
+             "joined by bounded queues; prints per-stage occupancy",
+    )
+    parser.add_argument(
+        "--queue-size",
+        type=int,
+        default=8,
+        metavar="N",
+        help="Capacity of each --pipeline queue (default 8)",
+    )
+    parser.add_argument(
+        "--preprocess-threads",
+        type=int,
+        metavar="N",
+        help="Concurrent preprocess threads with --pipeline (default: CPU count with GCC, else 1)",
+    )
+    parser.add_argument(
+        "--cache-dir",
+        help="Folder for run history (per-file timings of -j / --priority runs etc.); "
+             f"default {DEFAULT_CACHE_DIR}. Parsed rule files are only cached here "
+             "when it is given",
+    )
+    parser.add_argument(
+        "--changed-since",
+        metavar="REF",
+        help="Only analyze files changed since git REF (plus files including them); "
+             "take all other results from the cache",
+    )
+    git_source = parser.add_mutually_exclusive_group()
+    git_source.add_argument(
+        "--git-index",
+        action="store_true",
+        help="Analyze the staged content (the git index) instead of the working tree",
+    )
+    git_source.add_argument(
+        "--git-rev",
+        metavar="REV",
+        help="Analyze the files as committed in git REV, read from the object store "
+             "without a checkout",
+    )
+    parser.add_argument(
+        "--watch",
+        action="store_true",
+        help="Keep running: re-analyze changed files (and their dependents) in the given "
+             "directories and print violation diffs; no reports are written",
+    )
+    parser.add_argument(
+        "--include",
+        action="append",
+        metavar="GLOB",
+        help="File name pattern to pick up when walking directories "
+             f"(repeatable; default {' '.join(DEFAULT_INCLUDES)})",
+    )
+    parser.add_argument(
+        "--exclude",
+        action="append",
+        metavar="PATTERN",
+        help="gitignore-style pattern to skip when walking directories or globs (repeatable)",
+    )
+    parser.add_argument(
+        "--no-gitignore",
+        action="store_true",
+        help="Do not apply .gitignore files while walking directories",
+    )
+    parser.add_argument(
+        "--checkpoint",
+        nargs="?",
+        const="",
+        metavar="FILE",
+        help="Journal every finished file so an interrupted run can be resumed "
+             "(default FILE: <cache-dir>/checkpoint.ndjson)",
+    )
+    parser.add_argument(
+        "--resume",
+        action="store_true",
+        help="Continue an interrupted --checkpoint run: files unchanged since they were "
+             "journaled are not analyzed again (implies --checkpoint)",
+    )
+    parser.add_argument(
+        "--shard",
+        type=parse_shard_spec,
+        metavar="I/N",
+        help="Analyze only the I-th of N size-balanced parts of the file list (for CI fan-out; "
+             "combine the JSON reports with 'merge')",
+    )
+    parser.add_argument(
+        "--priority",
+        action="store_true",
+        help="Analyze files modified in git / recently first, then those with the most "
+             "violations last time, and print each result as soon as it is ready",
+    )
+    parser.add_argument(
+        "--sample",
+        type=parse_sample_spec,
+        metavar="N|FRACTION",
+        help="Analyze only a stratified random sample (a file count, or a fraction such as 0.05 "
+             "or 5%%) and estimate the violations of the whole file set per rule",
+    )
+    parser.add_argument(
+        "--sample-precision",
+        type=float,
+        metavar="P",
+        help="With --sample: keep sampling until the estimated total is within +-P "
+             "(e.g. 0.1 for 10%%) at the requested confidence",
+    )
+    parser.add_argument(
+        "--sample-confidence",
+        type=float,
+        default=0.95,
+        metavar="C",
+        help="Confidence level of the --sample intervals (default 0.95)",
+    )
+    parser.add_argument(
+        "--sample-seed",
+        type=int,
+        metavar="SEED",
+        help="Random seed of --sample (default: random, printed so a sample can be repeated)",
+    )
+    emit = parser.add_mutually_exclusive_group()
+    emit.add_argument(
+        "--emit-ninja",
+        metavar="FILE",
+        help="Do not analyze: write a ninja file with one analysis action per file "
+             "(inputs: file, rules, include closure in GCC mode) and a final merge",
+    )
+    emit.add_argument(
+        "--emit-make",
+        metavar="FILE",
+        help="Like --emit-ninja, as a GNU makefile",
+    )
+    parser.add_argument(
+        "--stamp-dir",
+        default=".complyc_build",
+        metavar="DIR",
+        help="Where --emit-ninja/--emit-make builds put per-file results and the merged "
+             "report (default .complyc_build; --json-report overrides the report path)",
+    )
+    parser.add_argument(
+        "files",
+        nargs="+",
+        help="C source files, directories (walked recursively) or glob patterns such as 'src/**/*.c'",
+    )
+    args = parser.parse_args(argv)
+
+    if args.format == "ndjson" and args.output in (None, "-"):
+        # stdout carries only the records; all other output goes to stderr
+        from contextlib import redirect_stdout
+
+        ndjson_out = sys.stdout
+        with redirect_stdout(sys.stderr):
+            return run(args, parser, ndjson_out)
+    return run(args, parser)
 
-    # Load style + rules from YAML
-    style, rules = load_rules(args.rules)
-    style = style or {}
 
-    # Base mode from YAML
-    preproc_mode = str(style.get("preprocessor", "builtin")).lower()
+def run(args: argparse.Namespace, parser: argparse.ArgumentParser, ndjson_out=None) -> int:
+    """Everything after argument parsing (ndjson_out: stdout for --format ndjson)."""
+    # Load style + rules from YAML. The rule bundle is only kept in a cache
+    # dir given on the command line: a plain run writes nothing to the cache
+    style, rules = load_rules(args.rules, cache_dir=args.cache_dir)
+    if args.cache_dir is None:
+        args.cache_dir = DEFAULT_CACHE_DIR
+    style = style or {}
 
     # Decide final use_gcc based on CLI override + YAML
-    if args.use_gcc:
-        use_gcc = True
-    elif args.no_gcc:
-        use_gcc = False
-    else:
-        use_gcc = (preproc_mode == "gcc")
+    use_gcc = resolve_use_gcc(style, args.use_gcc, args.no_gcc)
 
     print("[ComplyC] Preprocessor mode:",
           "GCC (-E -P)" if use_gcc else "builtin regex stripper")
 
-    per_file_violations = {}
+    if args.watch and args.shard:
+        parser.error("--shard cannot be combined with --watch")
+    git_mode = args.git_index or args.git_rev
+    build_file = args.emit_ninja or args.emit_make
+    if build_file and (args.watch or args.changed_since or git_mode or args.shard):
+        parser.error("--emit-ninja/--emit-make cannot be combined with --watch, --changed-since, "
+                     "--git-index/--git-rev or --shard")
+    checkpointing = args.checkpoint is not None or args.resume
+    if checkpointing and (args.watch or args.changed_since or git_mode or build_file):
+        parser.error("--checkpoint/--resume cannot be combined with --watch, --changed-since, "
+                     "--git-index/--git-rev or --emit-ninja/--emit-make")
+    if args.pipeline and (args.jobs != 1 or args.watch or args.changed_since or git_mode):
+        parser.error("--pipeline runs in-process; it cannot be combined with -j, --watch, "
+                     "--changed-since or --git-index/--git-rev")
+    if (args.sample_precision is not None or args.sample_seed is not None) and not args.sample:
+        parser.error("--sample-precision and --sample-seed require --sample")
+    if not 0.0 < args.sample_confidence < 1.0:
+        parser.error("--sample-confidence must be within (0, 1)")
+    if args.sample and (args.watch or args.changed_since or git_mode or build_file or args.shard
+                        or checkpointing):
+        parser.error("--sample cannot be combined with --watch, --changed-since, --git-index/--git-rev, "
+                     "--emit-ninja/--emit-make, --shard or --checkpoint/--resume")
+    ndjson = args.format == "ndjson"
+    if args.output and not ndjson:
+        parser.error("--output is only used with --format ndjson")
+    if ndjson and (args.watch or build_file):
+        parser.error("--format ndjson cannot be combined with --watch or --emit-ninja/--emit-make")
+    if args.priority and (args.watch or args.changed_since or git_mode or build_file or args.pipeline
+                          or checkpointing or args.sample):
+        parser.error("--priority cannot be combined with --watch, --changed-since, --git-index/--git-rev, "
+                     "--emit-ninja/--emit-make, --pipeline, --checkpoint/--resume or --sample")
+    if git_mode and (args.watch or args.changed_since):
+        parser.error("--git-index/--git-rev cannot be combined with --watch or --changed-since")
+
+    if args.watch:
+        from .watch import run_watch
+
+        run_watch(
+            args.files, rules, use_gcc,
+            includes=args.include,
+            excludes=args.exclude,
+            use_gitignore=not args.no_gitignore,
+        )
+        return 0
+
+    if build_file:
+        from .buildgen import write_make, write_ninja
+
+        sources = list(iter_sources(
+            args.files,
+            includes=args.include,
+            excludes=args.exclude,
+            use_gitignore=not args.no_gitignore,
+        ))
+        write = write_ninja if args.emit_ninja else write_make
+        count = write(build_file, sources, args.rules, use_gcc, args.cache_dir,
+                      args.stamp_dir, args.json_report)
+        print(f"[ComplyC] Wrote {build_file}: {count} per-file action(s) and a merge")
+        return 0
+
+    from .runner import InputOrder, iter_analyze, resolve_jobs
+    from .scheduler import RunStats, TimingStore
+
+    # ---------- Reports (JSON / HTML) ----------
+    if args.no_reports:
+        json_path, html_path = args.json_report, args.html_report
+    else:
+        json_path, html_path = resolve_report_paths(
+            args.files, args.json_report, args.html_report, args.clean_reports
+        )
+    if args.json_summary and not json_path:
+        parser.error("--json-summary needs a JSON report (drop --no-reports or add --json-report)")
+    if args.json_schema == 2 and not json_path:
+        parser.error("--json-schema 2 needs a JSON report (drop --no-reports or add --json-report)")
+
+    # The HTML report needs the summary first: finished files go to disk and
+    # are streamed back at the end
+    spill = None
+    if html_path:
+        from .spill import ResultSpill
+
+        spill = ResultSpill()
     severity_counter = Counter()
     total_violations = 0
 
+    # Only collect metrics when an export was requested
+    want_metrics = bool(args.metrics_csv or args.metrics_bin)
+    all_metrics = [] if want_metrics else None
+
     # ---------- Per-file analysis ----------
-    for path in args.files:
-        # parse with or without GCC, depending on resolved mode
-        ast = parse_c_file(path, use_gcc=use_gcc)
-        violations = run_rules(ast, rules, path)
-        per_file_violations[path] = violations
+    # Timings from previous runs drive largest-first scheduling
+    timings = TimingStore(args.cache_dir)
+    run_stats = RunStats()
+    # Under `make -jN` stay within make's job budget (see jobserver.py)
+    jobserver = None
+    if (args.jobs != 1 or (args.pipeline and use_gcc)) and not git_mode:
+        from .jobserver import Jobserver
+
+        try:
+            jobserver = Jobserver.from_environ()
+        except OSError as e:
+            print(f"[ComplyC] WARNING: make jobserver not usable ({e}); running one job at a time. "
+                  "Mark the recipe line with '+' to pass the jobserver on.")
+            args.jobs, args.preprocess_threads = 1, 1
+        if jobserver is not None:
+            print(f"[ComplyC] Using make jobserver ({jobserver.description})")
+
+    # Snapshot analysis reads blobs through one git process, in-process
+    parallel = resolve_jobs(args.jobs) > 1 and not git_mode
+
+    # Results arrive in input order regardless of -j, so output is identical
+    # to a serial run.
+    snapshot = None
+    journal = None
+    if git_mode:
+        from .gitsnapshot import GitSnapshot
+
+        snapshot = GitSnapshot(args.git_rev)
+        sources = snapshot.select(args.files, includes=args.include, excludes=args.exclude)
+        print(f"[ComplyC] Reading {len(sources)} file(s) from the git {snapshot.label}")
+    else:
+        sources = iter_sources(
+            args.files,
+            includes=args.include,
+            excludes=args.exclude,
+            use_gitignore=not args.no_gitignore,
+        )
+    shard_info = None
+    if args.shard:
+        # Partitioning needs the complete list (and the same one on every shard)
+        sources, shard_info = select_shard(list(sources), *args.shard)
+        print(f"[ComplyC] Shard {shard_info['index']}/{shard_info['count']}: "
+              f"{len(sources)} of {shard_info['total_files']} file(s)")
+    # Completion-order results go to the console and the NDJSON stream as
+    # they come; the reports get them back in input order
+    completion_order = args.priority or (ndjson and not checkpointing)
+    reorder = InputOrder() if args.priority else None
+    if args.priority:
+        from .priority import prioritize
+
+        sources = prioritize(list(reorder.track(sources)), timings)
+    sample = None
+    if args.sample:
+        from .sample import StratifiedSample
+
+        sources = list(sources)
+        sample = StratifiedSample(sources, [r["id"] for r in rules], args.sample,
+                                  seed=args.sample_seed, confidence=args.sample_confidence)
+        print(f"[ComplyC] Sampling {sample.initial} of {sample.population} file(s) "
+              f"in {len(sample.strata)} strata (seed {sample.seed})")
+    if snapshot is not None:
+        from .gitsnapshot import iter_snapshot
+
+        results = iter_snapshot(
+            snapshot, sources, rules, use_gcc, args.cache_dir, want_metrics=want_metrics,
+        )
+    elif args.changed_since:
+        from .incremental import iter_changed_since
+
+        results = iter_changed_since(
+            sources, args.changed_since, rules, use_gcc, args.cache_dir,
+            jobs=args.jobs, want_metrics=want_metrics, timings=timings, stats=run_stats,
+            jobserver=jobserver,
+        )
+    else:
+        if completion_order and not args.pipeline and reorder is None:
+            reorder = InputOrder()
+
+        def analyze(paths):
+            if args.pipeline:
+                from .pipeline import iter_pipeline
+
+                threads = args.preprocess_threads or ((os.cpu_count() or 1) if use_gcc else 1)
+                return iter_pipeline(
+                    paths, rules, use_gcc, want_metrics=want_metrics,
+                    queue_size=max(1, args.queue_size), preprocess_threads=threads,
+                    stats=run_stats, jobserver=jobserver,
+                )
+            if completion_order and not args.priority:
+                paths = reorder.track(paths)
+            return iter_analyze(
+                paths, rules, use_gcc, jobs=args.jobs, want_metrics=want_metrics,
+                timings=timings, stats=run_stats, jobserver=jobserver,
+                completion_order=completion_order,
+            )
+
+        if checkpointing:
+            from .checkpoint import DEFAULT_NAME, Journal, iter_checkpointed
+
+            journal = Journal(args.checkpoint or os.path.join(args.cache_dir, DEFAULT_NAME),
+                              rules, use_gcc, want_metrics)
+            results = iter_checkpointed(sources, journal, args.resume, analyze)
+        elif sample is not None:
+            from .sample import iter_sample
+
+            results = iter_sample(sample, analyze, args.sample_precision)
+        else:
+            results = analyze(sources)
+
+    # The JSON report is written as files complete (summary as trailer)
+    json_report = None
+    if json_path:
+        head = {"shard": shard_info} if shard_info else None
+        try:
+            if args.json_schema == 2:
+                from .compact import CompactReportFile
+
+                json_report = CompactReportFile(json_path, rules, head=head, summary_path=args.json_summary)
+            else:
+                from .reporters import JsonReportFile
+
+                json_report = JsonReportFile(json_path, head=head, summary_path=args.json_summary)
+        except OSError as e:
+            parser.error(f"cannot write the JSON report: {e}")
+
+    html_pages = None
+    if args.html_dir:
+        from .htmlpages import PagedHtmlReport
+
+        html_pages = PagedHtmlReport(args.html_dir, rules)
+
+    sarif = None
+    if args.sarif_report:
+        from .sarif import SarifReportFile
+
+        sarif = SarifReportFile(args.sarif_report, rules, style)
+
+    stream = None
+    if ndjson:
+        from .ndjson import NdjsonWriter
+
+        stream_file = open(args.output, "w", encoding="utf-8") if ndjson_out is None else ndjson_out
+        stream = NdjsonWriter(stream_file, interval=args.progress_interval)
+        stream.start(preprocessor="gcc" if use_gcc else "builtin", rules=len(rules))
+    # Per-file text goes to the console unless the records took its place
+    text_output = not args.quiet and ndjson_out is None
+
+    total_files = 0
+    violation_counts: Dict[str, int] = {}  # violation density history for --priority
+    first_result = None
+    started = time.perf_counter()
+    for path, violations, metrics in results:
+        total_files += 1
+        violation_counts[path] = len(violations)
+        if first_result is None:
+            first_result = time.perf_counter() - started
+        if stream is not None:
+            stream.add(path, violations)
+        due = reorder.add(path, violations, metrics) if reorder is not None else [(path, violations, metrics)]
+        for report_path, report_violations, report_metrics in due:
+            if json_report is not None:
+                json_report.add(report_path, report_violations)
+            if sarif is not None:
+                sarif.add(report_path, report_violations)
+            if html_pages is not None:
+                html_pages.add(report_path, report_violations)
+            if spill is not None:
+                spill.add(report_path, report_violations)
+            if want_metrics:
+                all_metrics.extend(report_metrics)
 
         total_violations += len(violations)
         for v in violations:
@@ -101,63 +658,96 @@ def main():
             severity_counter[sev] += 1
 
         # Per-file console output (unless quiet)
-        if not args.quiet:
-            print(f"\nFile: {path}")
-            if not violations:
-                print("  No violations found ✅")
-            else:
-                for v in violations:
-                    line = f"line {v.line}" if v.line is not None else "line ?"
-                    print(f"  [{v.rule_id}] {line}: {v.message}")
+        if text_output:
+            print_file_result(path, violations)
+            if args.priority:
+                sys.stdout.flush()
+    if snapshot is not None:
+        snapshot.close()
+    if jobserver is not None:
+        jobserver.close()
 
     # ---------- Summary (always printed) ----------
-    print("\n==================== Summary ====================")
-    print(f"Total files analyzed   : {len(per_file_violations)}")
-    print(f"Total violations found : {total_violations}")
-
-    if total_violations == 0:
-        print("Overall status         : ✅ Clean (no violations)")
-    else:
-        print("Overall status         : ⚠️ Issues detected")
-        print("Violations by severity :")
-        for sev, count in sorted(severity_counter.items()):
-            label = sev.capitalize()
-            print(f"  - {label:11} : {count}")
-
-    print("=================================================\n")
-
-    # ---------- Reports (JSON / HTML) ----------
-    reports_dir = ensure_reports_dir()
+    print_summary_header(total_files, total_violations, severity_counter)
+
+    if parallel:
+        util = run_stats.utilization()
+        avg_util = sum(util) / len(util) if util else 0.0
+        print(f"Workers                : {run_stats.jobs} "
+              f"(avg utilization {avg_util:.0%}, {run_stats.steals} steals)")
+        print(f"Wall time              : {run_stats.wall_seconds:.2f}s")
+        print(f"Critical-path file     : {run_stats.critical_file} "
+              f"({run_stats.critical_seconds:.2f}s)")
+    if run_stats.pipeline is not None:
+        print(f"Wall time              : {run_stats.wall_seconds:.2f}s")
+        print("Pipeline stages        :")
+        for line in run_stats.pipeline.summary_lines():
+            print(line)
+    if run_stats.jobserver_peak is not None:
+        print(f"Jobserver              : at most {run_stats.jobserver_peak} job(s) at once")
+    if args.priority and first_result is not None:
+        print(f"First result after     : {first_result:.2f}s")
+    if sample is not None:
+        for line in sample.summary_lines():
+            print(line)
+
+    print_summary_footer()
+
+    # Timing history is only kept for the runs that use it (a plain run
+    # writes nothing to the cache dir)
+    if parallel or args.priority:
+        for path, seconds in run_stats.file_seconds.items():
+            timings.record(path, seconds, violation_counts.get(path))
+        try:
+            timings.save()
+        except OSError as e:
+            print(f"[ComplyC] Could not save timings to {args.cache_dir}: {e}")
+
+    # Scheduler statistics only make sense (and are only reported) for -j > 1 and --pipeline
+    run_info = run_stats.to_dict() if parallel or run_stats.pipeline else None
+    sample_info = sample.to_dict() if sample is not None else None
+
+    if json_report is not None or stream is not None:
+        from .reporters import report_tail
+
+        tail = report_tail(run_info, sample_info)
+        if stream is not None:
+            stream.finish(tail)
+            if ndjson_out is None:
+                stream.out.close()
+        if json_report is not None:
+            json_report.close(tail)
+
+    if sarif is not None:
+        sarif.close()
+    if html_pages is not None:
+        html_pages.close(run_info=run_info, shard_info=shard_info, sample_info=sample_info)
 
-    if args.clean_reports:
-        clean_reports_folder()
+    if html_path:
+        from .reporters import write_html_report
 
-    ts = make_timestamp()
+        write_html_report(spill, html_path, run_info=run_info, shard_info=shard_info,
+                          sample_info=sample_info)
 
-    # Build a short identifier from the C filenames
-    file_basenames = [os.path.splitext(os.path.basename(f))[0] for f in args.files]
+    if spill is not None:
+        spill.close()
 
-    # If there is only one file, use its name. If multiple, join with "_And_"
-    if len(file_basenames) == 1:
-        file_tag = file_basenames[0]
-    else:
-        file_tag = "_And_".join(file_basenames)
+    # ---------- Metrics export (CSV / columnar) ----------
+    if args.metrics_csv:
+        from .metrics import write_metrics_csv
 
-    # Start from user-provided paths (if any)
-    json_path = args.json_report
-    html_path = args.html_report
+        write_metrics_csv(all_metrics, args.metrics_csv)
 
-    # If user didn't specify any paths, generate timestamped defaults with file names
-    if json_path is None and html_path is None:
-        json_path = os.path.join(reports_dir, f"complyc_report_{file_tag}_{ts}.json")
-        html_path = os.path.join(reports_dir, f"complyc_report_{file_tag}_{ts}.html")
+    if args.metrics_bin:
+        from .metrics import write_metrics_columnar
 
-    if json_path:
-        write_json_report(per_file_violations, json_path)
+        write_metrics_columnar(all_metrics, args.metrics_bin)
 
-    if html_path:
-        write_html_report(per_file_violations, html_path)
+    # Everything is written: a later --resume would have nothing to resume
+    if journal is not None:
+        journal.finish()
+    return 0
 
 
 if __name__ == "__main__":
-    main()
+    sys.exit(main())
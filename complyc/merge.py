@@ -0,0 +1,254 @@
+"""
+merge.py – Merge shard JSON reports (`complyc merge`)
+
+Combines the JSON reports of a `--shard i/N` fan-out into one report with a
+recomputed summary. Each shard report is read incrementally (only one file
+entry per shard is held at a time) and the shards are k-way merged back into
+the original file order, using the positions recorded in their "shard"
+blocks. The merged report has the same layout as an unsharded one.
+
+With --ordered the inputs are not shards but reports to concatenate in the
+order given (the per-file stamps of --emit-ninja/--emit-make). Long input
+lists can be passed in a response file: @FILE (whitespace separated, shell
+quoting).
+
+Usage:
+    python -m complyc.main merge -o merged.json shard-1.json shard-2.json ...
+"""
+
+from __future__ import annotations
+
+import argparse
+import heapq
+import itertools
+import json
+import os
+import shlex
+from collections import Counter
+from typing import Any, Dict, Iterator, List, Optional, Tuple
+
+from .console import print_summary_footer, print_summary_header
+from .reporters import open_report, write_json_stream
+
+
+READ_CHUNK = 64 * 1024
+
+
+class ReportReader:
+    """
+    Incremental reader for one JSON report.
+
+    Top-level keys before "files" are available as `header` right away; the
+    file entries are streamed by iter_files(), after which the keys that
+    followed them (e.g. "summary") are available as `trailer`.
+
+    `arrays` names the top-level arrays that may be streamed (the first one
+    found is, see `array`); with `versioned` schema v2 reports are read too
+    (compact.py streams their "violations" this way).
+    """
+
+    def __init__(self, path: str, arrays: Tuple[str, ...] = ("files",), versioned: bool = False):
+        self.path = path
+        self.arrays = arrays
+        self.versioned = versioned
+        self.array: Optional[str] = None
+        self._f = open_report(path, "r")
+        self._decoder = json.JSONDecoder()
+        self._buf = ""
+        self._pos = 0
+        self._eof = False
+        self.header: Dict[str, Any] = {}
+        self.trailer: Dict[str, Any] = {}
+
+        try:
+            self._expect("{")
+            self._read_members(self.header)
+        except BaseException:
+            self.close()
+            raise
+
+    # ---------- low-level scanning ----------
+
+    def _fill(self) -> bool:
+        data = self._f.read(READ_CHUNK)
+        if not data:
+            self._eof = True
+            return False
+        self._buf = self._buf[self._pos:] + data
+        self._pos = 0
+        return True
+
+    def _peek(self) -> str:
+        while True:
+            while self._pos < len(self._buf) and self._buf[self._pos].isspace():
+                self._pos += 1
+            if self._pos < len(self._buf):
+                return self._buf[self._pos]
+            if not self._fill():
+                return ""
+
+    def _expect(self, ch: str):
+        if self._peek() != ch:
+            raise ValueError(f"{self.path}: expected {ch!r} at offset {self._pos}")
+        self._pos += 1
+
+    def _value(self) -> Any:
+        self._peek()
+        while True:
+            try:
+                value, end = self._decoder.raw_decode(self._buf, self._pos)
+            except json.JSONDecodeError:
+                if not self._fill():
+                    raise
+                continue
+            # A number (or literal) touching the end of the buffer may continue
+            if end == len(self._buf) and not self._eof and self._fill():
+                continue
+            self._pos = end
+            return value
+
+    def _read_members(self, into: Dict[str, Any]):
+        """Read "key": value pairs into `into`, stopping at a streamed array or the end."""
+        while True:
+            ch = self._peek()
+            if ch == "}":
+                self._pos += 1
+                return
+            if ch == ",":
+                self._pos += 1
+                continue
+            key = self._value()
+            self._expect(":")
+            if key == "version" and into is self.header and not self.versioned:
+                raise ValueError(f"{self.path}: schema v2 report; convert it with "
+                                 f"'complyc convert' first")
+            if key in self.arrays and self.array is None:
+                self.array = key
+                return
+            into[key] = self._value()
+
+    # ---------- public ----------
+
+    def close(self):
+        self._f.close()
+
+    def iter_files(self) -> Iterator[Any]:
+        """The items of the streamed array (see `array`); closes the report."""
+        if self.array is not None:
+            self._expect("[")
+            while True:
+                ch = self._peek()
+                if ch == "]":
+                    self._pos += 1
+                    break
+                if ch == ",":
+                    self._pos += 1
+                    continue
+                yield self._value()
+            self._read_members(self.trailer)
+        self.close()
+
+
+# ---------- merging ----------
+
+def _keyed(reader: ReportReader) -> Iterator[Tuple[Any, Dict[str, Any]]]:
+    positions = (reader.header.get("shard") or {}).get("positions")
+    for i, entry in enumerate(reader.iter_files()):
+        if positions is not None and i < len(positions):
+            yield (0, positions[i]), entry
+        else:
+            # Not a shard report: fall back to path order
+            yield (1, entry["file"]), entry
+
+
+def check_shards(readers: List[ReportReader]) -> List[str]:
+    """Problems that make the shard set incomplete or inconsistent."""
+    infos = [(r.path, r.header.get("shard")) for r in readers]
+    problems = [f"{path}: not a shard report" for path, info in infos if not info]
+    infos = [(path, info) for path, info in infos if info]
+    if not infos:
+        return problems
+
+    counts = {info["count"] for _, info in infos}
+    digests = {info.get("partition") for _, info in infos}
+    if len(counts) > 1:
+        problems.append(f"shard reports disagree on the shard count: {sorted(counts)}")
+    if len(digests) > 1:
+        problems.append("shard reports were partitioned differently "
+                        "(different file lists or file sizes)")
+    seen = Counter(info["index"] for _, info in infos)
+    for index, n in sorted(seen.items()):
+        if n > 1:
+            problems.append(f"shard {index} given {n} times")
+    if len(counts) == 1:
+        missing = sorted(set(range(1, counts.pop() + 1)) - set(seen))
+        if missing:
+            problems.append("missing shard(s): " + ", ".join(map(str, missing)))
+    return problems
+
+
+def merge_reports(
+    paths: List[str], outfile: str, allow_partial: bool = False, ordered: bool = False
+) -> Dict[str, Any]:
+    if ordered:
+        # Opened one after another: thousands of stamps never hold many fds
+        readers: List[ReportReader] = []
+
+        def opened(path: str) -> ReportReader:
+            readers.append(ReportReader(path))
+            return readers[-1]
+
+        entries = itertools.chain.from_iterable(opened(p).iter_files() for p in paths)
+    else:
+        readers = [ReportReader(p) for p in paths]
+        problems = check_shards(readers)
+        for problem in problems:
+            print(f"[ComplyC] {problem}")
+        if problems and not allow_partial:
+            raise SystemExit("[ComplyC] Refusing to merge (use --allow-partial to merge anyway)")
+
+        streams = [_keyed(r) for r in readers]
+        entries = (entry for _, entry in heapq.merge(*streams, key=lambda item: item[0]))
+
+    tmp = outfile + ".tmp"
+    with open(tmp, "w", encoding="utf-8") as out:
+        summary = write_json_stream(out, entries)
+    os.replace(tmp, outfile)
+
+    # Cross-check against the shards' own summaries
+    expected = sum((r.trailer.get("summary") or {}).get("total_files", 0) for r in readers)
+    if expected != summary["total_files"]:
+        print(f"[ComplyC] Warning: shard summaries list {expected} file(s), "
+              f"merged {summary['total_files']}")
+    return summary
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(
+        prog="complyc merge",
+        description="Merge the JSON reports of a --shard fan-out into one report",
+        fromfile_prefix_chars="@",
+    )
+    parser.convert_arg_line_to_args = shlex.split
+    parser.add_argument("-o", "--output", required=True, help="Path of the merged JSON report")
+    parser.add_argument(
+        "--allow-partial",
+        action="store_true",
+        help="Merge even if shards are missing, duplicated or were partitioned differently",
+    )
+    parser.add_argument(
+        "--ordered",
+        action="store_true",
+        help="Inputs are not shards: concatenate them in the given order (per-file stamps)",
+    )
+    parser.add_argument("reports", nargs="+", help="Shard JSON reports (or @FILE listing them)")
+    args = parser.parse_args(argv)
+
+    summary = merge_reports(args.reports, args.output, args.allow_partial, args.ordered)
+    print(f"[ComplyC] Merged {len(args.reports)} report(s) into {args.output}")
+    by_severity = Counter()
+    for sev, n in summary["by_severity"].items():
+        by_severity[sev.lower()] += n
+    print_summary_header(summary["total_files"], summary["total_violations"], by_severity)
+    print_summary_footer()
+    return 0
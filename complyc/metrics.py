@@ -0,0 +1,264 @@
+"""
+metrics.py – Per-function metrics for ComplyC
+
+Metrics are computed once per FuncDef by a single visitor and cached in the
+rule context, so the function-scope checks (length, CC, nesting, parameters)
+and the metrics export share the same traversal.
+"""
+
+from __future__ import annotations
+
+import csv
+import json
+import struct
+import sys
+from array import array
+from dataclasses import dataclass, fields
+from typing import Dict, Iterable, List, Optional
+
+from pycparser import c_ast
+
+
+@dataclass
+class FunctionMetrics:
+    file: str
+    function: str
+    line: Optional[int] = None
+    loc: int = 0
+    statements: int = 0
+    parameters: int = 0
+    cyclomatic_complexity: int = 1
+    max_nesting: int = 0
+    calls: int = 0
+    literals: int = 0
+    returns: int = 0
+
+
+METRIC_FIELDS = [f.name for f in fields(FunctionMetrics)]
+
+# Columns stored as dictionary-encoded strings in the columnar format;
+# every other column is a plain int32 (None -> -1).
+STRING_COLUMNS = ("file", "function")
+
+
+# ---------- computation ----------
+
+class _FunctionMetricsVisitor(c_ast.NodeVisitor):
+    """
+    Single-pass visitor collecting every per-function metric.
+
+    CC counts if/for/while/case/default and nesting counts if/for/while/switch,
+    exactly as the original FUNC_CC_001 / FUNC_NESTING_001 visitors did.
+
+    statements counts every statement node in a statement position (block
+    items, if/else branches, loop bodies, case/default/label bodies), so
+    brace-less bodies count too; a { } block itself is not a statement,
+    only what it contains.
+    """
+
+    def __init__(self):
+        self.cc = 1
+        self.max_depth = 0
+        self.current = 0
+        self.calls = 0
+        self.literals = 0
+        self.returns = 0
+        self.statements = 0
+
+    def _nested(self, n, counts_cc: bool):
+        if counts_cc:
+            self.cc += 1
+        self.current += 1
+        self.max_depth = max(self.max_depth, self.current)
+        self.generic_visit(n)
+        self.current -= 1
+
+    def _statement(self, *nodes):
+        for node in nodes:
+            if node is not None and not isinstance(node, c_ast.Compound):
+                self.statements += 1
+
+    def visit_If(self, n):
+        self._statement(n.iftrue, n.iffalse)
+        self._nested(n, counts_cc=True)
+
+    def visit_For(self, n):
+        self._statement(n.stmt)
+        self._nested(n, counts_cc=True)
+
+    def visit_While(self, n):
+        self._statement(n.stmt)
+        self._nested(n, counts_cc=True)
+
+    def visit_DoWhile(self, n):
+        self._statement(n.stmt)
+        self.generic_visit(n)
+
+    def visit_Switch(self, n):
+        self._statement(n.stmt)
+        self._nested(n, counts_cc=False)
+
+    def visit_Case(self, n):
+        self.cc += 1
+        self._statement(*(n.stmts or []))
+        self.generic_visit(n)
+
+    def visit_Default(self, n):
+        self.cc += 1
+        self._statement(*(n.stmts or []))
+        self.generic_visit(n)
+
+    def visit_Label(self, n):
+        self._statement(n.stmt)
+        self.generic_visit(n)
+
+    def visit_Compound(self, n):
+        self._statement(*(n.block_items or []))
+        self.generic_visit(n)
+
+    def visit_FuncCall(self, n):
+        self.calls += 1
+        self.generic_visit(n)
+
+    def visit_Constant(self, n):
+        self.literals += 1
+        self.generic_visit(n)
+
+    def visit_Return(self, n):
+        self.returns += 1
+        self.generic_visit(n)
+
+
+def _function_length(node: c_ast.FuncDef) -> int:
+    if not node.coord:
+        return 0
+    start = node.coord.line
+    end = start
+    if node.body and getattr(node.body, "block_items", None):
+        last = node.body.block_items[-1]
+        if last and last.coord:
+            end = last.coord.line
+    return end - start + 1
+
+
+def _parameter_count(node: c_ast.FuncDef) -> int:
+    func_type = node.decl.type
+    while hasattr(func_type, "type") and not isinstance(func_type, c_ast.FuncDecl):
+        func_type = func_type.type
+    if not isinstance(func_type, c_ast.FuncDecl):
+        return 0
+    return len(getattr(func_type.args, "params", []) or [])
+
+
+def compute_function_metrics(node: c_ast.FuncDef, file_path: str) -> FunctionMetrics:
+    """Compute all metrics for one function definition in a single walk."""
+    v = _FunctionMetricsVisitor()
+    v.visit(node)
+    return FunctionMetrics(
+        file=file_path,
+        function=node.decl.name,
+        line=node.coord.line if node.coord else None,
+        loc=_function_length(node),
+        statements=v.statements,
+        parameters=_parameter_count(node),
+        cyclomatic_complexity=v.cc,
+        max_nesting=v.max_depth,
+        calls=v.calls,
+        literals=v.literals,
+        returns=v.returns,
+    )
+
+
+def function_metrics(node: c_ast.FuncDef, ctx: Dict) -> FunctionMetrics:
+    """Return the (cached) metrics for node, computing them on first use."""
+    cache = ctx.setdefault("metrics_cache", {})
+    m = cache.get(id(node))
+    if m is None:
+        m = compute_function_metrics(node, ctx["file_path"])
+        cache[id(node)] = m
+    return m
+
+
+# ---------- CSV export ----------
+
+def write_metrics_csv(rows: Iterable[FunctionMetrics], outfile: str):
+    """Write one CSV row per function."""
+    with open(outfile, "w", encoding="utf-8", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(METRIC_FIELDS)
+        for m in rows:
+            writer.writerow([getattr(m, name) for name in METRIC_FIELDS])
+    print(f"[ComplyC] Metrics CSV written to {outfile}")
+
+
+# ---------- columnar binary export ----------
+#
+# Layout (all integers little-endian):
+#   8 bytes   magic  b"CCMETR01"
+#   uint32    length of the JSON header that follows
+#   bytes     JSON header: {"rows": n, "columns": [{"name", "type", "dictionary"?}]}
+#   n*int32   one contiguous block per column, in header order
+#
+# String columns are dictionary-encoded (the dictionary lives in the header),
+# so every column block has the same size and column k starts at
+# data_offset + k * rows * 4 – a reader can mmap and slice single columns.
+
+COLUMNAR_MAGIC = b"CCMETR01"
+
+
+def _le_int32(values: List[int]) -> bytes:
+    arr = array("i", values)
+    if sys.byteorder != "little":
+        arr.byteswap()
+    return arr.tobytes()
+
+
+def write_metrics_columnar(rows: List[FunctionMetrics], outfile: str):
+    """Write metrics in the ComplyC columnar binary format (see layout above)."""
+    columns = []
+    blocks = []
+    for name in METRIC_FIELDS:
+        values = [getattr(m, name) for m in rows]
+        if name in STRING_COLUMNS:
+            index: Dict[str, int] = {}
+            codes = [index.setdefault(val, len(index)) for val in values]
+            columns.append({"name": name, "type": "dict_int32", "dictionary": list(index)})
+            blocks.append(_le_int32(codes))
+        else:
+            columns.append({"name": name, "type": "int32"})
+            blocks.append(_le_int32([-1 if val is None else val for val in values]))
+
+    header = json.dumps({"rows": len(rows), "columns": columns}).encode("utf-8")
+    with open(outfile, "wb") as f:
+        f.write(COLUMNAR_MAGIC)
+        f.write(struct.pack("<I", len(header)))
+        f.write(header)
+        for block in blocks:
+            f.write(block)
+    print(f"[ComplyC] Metrics columnar file written to {outfile}")
+
+
+def read_metrics_columnar(path: str) -> Dict[str, list]:
+    """Read a columnar metrics file back into {column_name: [values]}."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != COLUMNAR_MAGIC:
+        raise ValueError(f"{path} is not a ComplyC columnar metrics file")
+    (header_len,) = struct.unpack_from("<I", data, 8)
+    header = json.loads(data[12:12 + header_len].decode("utf-8"))
+    n = header["rows"]
+    offset = 12 + header_len
+
+    result: Dict[str, list] = {}
+    for col in header["columns"]:
+        arr = array("i")
+        arr.frombytes(data[offset:offset + n * 4])
+        if sys.byteorder != "little":
+            arr.byteswap()
+        offset += n * 4
+        if col["type"] == "dict_int32":
+            dictionary = col["dictionary"]
+            result[col["name"]] = [dictionary[i] for i in arr]
+        else:
+            result[col["name"]] = [None if (col["name"] == "line" and i < 0) else i for i in arr]
+    return result
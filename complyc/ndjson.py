@@ -0,0 +1,82 @@
+"""
+ndjson.py – Newline-delimited JSON stream output (`--format ndjson`)
+
+One JSON object per line, written and flushed as each file completes, for
+log pipelines that cannot wait for the end of the run:
+
+    {"type": "start", "version": 1, "preprocessor": "gcc", "rules": 21}
+    {"type": "violation", "file": ..., "line": ..., "rule_id": ..., "severity": ..., "message": ..., "reference": ...}
+    {"type": "file", "file": ..., "violations": 2}
+    {"type": "progress", "files": 640, "violations": 1523, "elapsed": 10.0}
+    {"type": "summary", "total_files": ..., "total_violations": ..., "by_severity": {...}, "elapsed": ...}
+
+Every file gets a "file" record after its violations (also when clean), so
+consumers know it is done. "progress" records follow a file at most every
+`interval` seconds; "summary" is always the last record and carries the
+report's summary (plus the "run" / "sample" blocks when present).
+
+In parallel runs files are streamed in completion order; the JSON/HTML/SARIF
+reports written alongside keep input order.
+"""
+
+from __future__ import annotations
+
+import json
+import time
+from dataclasses import asdict
+from typing import Any, Dict, Iterable, Optional, TextIO
+
+NDJSON_VERSION = 1
+DEFAULT_PROGRESS_SECONDS = 5.0
+
+
+class NdjsonWriter:
+    def __init__(self, out: TextIO, interval: float = DEFAULT_PROGRESS_SECONDS):
+        self.out = out
+        self.interval = interval
+        self.total_files = 0
+        self.total_violations = 0
+        self.by_severity: Dict[str, int] = {}
+        self._start = time.perf_counter()
+        self._last_progress = self._start
+
+    def _write(self, record: Dict[str, Any]):
+        self.out.write(json.dumps(record) + "\n")
+
+    def start(self, **info: Any):
+        self._write({"type": "start", "version": NDJSON_VERSION, **info})
+        self.out.flush()
+
+    def add(self, path: str, violations: Iterable[Any]):
+        """One finished file: its violations, then its "file" record; flushed."""
+        count = 0
+        for v in violations:
+            self._write({"type": "violation", **asdict(v), "file": path})
+            count += 1
+            sev = v.severity or "unspecified"
+            self.by_severity[sev] = self.by_severity.get(sev, 0) + 1
+        self._write({"type": "file", "file": path, "violations": count})
+        self.total_files += 1
+        self.total_violations += count
+
+        now = time.perf_counter()
+        if now - self._last_progress >= self.interval:
+            self._last_progress = now
+            self._write({
+                "type": "progress",
+                "files": self.total_files,
+                "violations": self.total_violations,
+                "elapsed": round(now - self._start, 3),
+            })
+        self.out.flush()
+
+    def finish(self, tail: Optional[Dict[str, Any]] = None):
+        self._write({
+            "type": "summary",
+            "total_files": self.total_files,
+            "total_violations": self.total_violations,
+            "by_severity": dict(self.by_severity),
+            "elapsed": round(time.perf_counter() - self._start, 3),
+            **(tail or {}),
+        })
+        self.out.flush()
@@ -1,7 +1,7 @@
 import re
-import subprocess
-import tempfile
 import os
+from typing import Sequence
+
 from pycparser import CParser, c_ast
 
 
@@ -85,54 +85,112 @@ def preprocess_code_for_pycparser(code: str) -> str:
     return with_typedefs
 
 
+# ============================================================
+#   Line-preserving variant (editor integration)
+# ============================================================
+
+def blank_c_comments(code: str) -> str:
+    """Like remove_c_comments(), but a block comment leaves its newlines behind."""
+    pattern = r'//.*?$|/\*.*?\*/'
+    return re.sub(
+        pattern,
+        lambda m: "\n" * m.group(0).count("\n"),
+        code,
+        flags=re.MULTILINE | re.DOTALL,
+    )
+
+
+def blank_preprocessor_directives(code: str) -> str:
+    """Like remove_preprocessor_directives(), but blank lines (and continuations) are kept."""
+    cleaned_lines = []
+    continued = False
+    for line in code.split("\n"):
+        if continued or line.lstrip().startswith("#"):
+            continued = line.rstrip().endswith("\\")
+            cleaned_lines.append("")
+            continue
+        cleaned_lines.append(line)
+    return "\n".join(cleaned_lines)
+
+
+def preprocess_code_preserving_lines(code: str) -> str:
+    """
+    Comment/directive stripping that keeps every token on its original line.
+
+    No typedefs are injected; callers prepend them followed by a #line
+    directive (see line_marker()), so diagnostics point at the real lines.
+    """
+    return blank_preprocessor_directives(blank_c_comments(code))
+
+
+def line_marker(line: int, path: str) -> str:
+    """A #line directive that pycparser honours when assigning coordinates."""
+    escaped = path.replace("\\", "\\\\").replace('"', '\\"')
+    return f'#line {line} "{escaped}"\n'
+
+
 # ============================================================
 #   GCC-based Preprocessing (optional mode)
 # ============================================================
 
-def preprocess_with_gcc(path: str) -> str:
+class PreprocessError(RuntimeError):
+    """GCC preprocessing failed; the message carries the command and gcc's output."""
+
+
+def preprocess_with_gcc(path: str, quote_dirs: Sequence[str] = ()) -> str:
     """
     Use GCC as a preprocessor on the given source file.
 
     Command used:
-        gcc -E -P <path> -o <temp_file>
+        gcc -E -P [-iquote <dir> ...] <path> -o <temp_file>
 
     -E : only run the preprocessor
     -P : inhibit linemarkers (#line), which confuse pycparser
+    -iquote : extra directories for quoted #include "..." (e.g. the original
+              directory of a file preprocessed from a temporary copy)
 
     Returns:
         The preprocessed code as a string with injected fake typedefs.
+
+    Raises PreprocessError (nothing is printed: callers may be libraries).
     """
+    # Imported here: builtin-mode runs never need them (start-up time)
+    import subprocess
+    import tempfile
+
     # Create a temporary file to hold the preprocessed output
     fd, tmp_out_path = tempfile.mkstemp(suffix=".c", prefix="complyc_gcc_")
     os.close(fd)  # We only need the path; gcc will write to it directly.
 
-    cmd = ["gcc", "-E", "-P", "-I", "fake_libc_include", path, "-o", tmp_out_path]
+    cmd = ["gcc", "-E", "-P", "-I", "fake_libc_include"]
+    for d in quote_dirs:
+        cmd += ["-iquote", d]
+    cmd += [path, "-o", tmp_out_path]
 
     try:
-        # Capture stdout/stderr for debugging if something goes wrong
-        result = subprocess.run(
+        # Capture stdout/stderr for the error message if something goes wrong
+        subprocess.run(
             cmd,
             check=True,
             stdout=subprocess.PIPE,
             stderr=subprocess.PIPE,
             text=True,
         )
-    except FileNotFoundError:
-        print("[ComplyC] ERROR: gcc not found on system PATH.")
-        print("[ComplyC] Hint: Install GCC or remove --use-gcc / set preprocessor: 'builtin'.")
-        raise
-    except subprocess.CalledProcessError as e:
-        print("[ComplyC] GCC preprocessing failed.")
-        print("[ComplyC] Command :", " ".join(cmd))
-        print("[ComplyC] Stdout  :", e.stdout)
-        print("[ComplyC] Stderr  :", e.stderr)
-        # Re-raise so the caller can decide how to handle it
-        raise
-
-    # Read the preprocessed file
-    try:
+        # Read the preprocessed file
         with open(tmp_out_path, "r", encoding="utf-8") as f:
             preprocessed_code = f.read()
+    except FileNotFoundError as e:
+        if e.filename == tmp_out_path:
+            raise
+        raise PreprocessError(
+            "gcc not found on system PATH. "
+            "Hint: Install GCC or remove --use-gcc / set preprocessor: 'builtin'."
+        ) from e
+    except subprocess.CalledProcessError as e:
+        output = "\n".join(part.strip() for part in (e.stdout, e.stderr) if part and part.strip())
+        raise PreprocessError(
+            f"GCC preprocessing of {path} failed.\nCommand : {' '.join(cmd)}\n{output}"
+        ) from e
     finally:
         # Best-effort cleanup of the temporary file
         try:
@@ -199,11 +257,32 @@ def sanitize_gcc_output_for_pycparser(code: str) -> str:
     return "\n".join(cleaned_lines)
 
 
+# ============================================================
+#   Parser instance reuse
+# ============================================================
+
+_PARSER = None
+
+
+def get_parser() -> CParser:
+    """
+    Return a process-wide CParser instance.
+
+    Building a CParser sets up its lexer and grammar tables; CParser.parse()
+    resets all per-parse state, so one instance can serve every file analyzed
+    by this process (including long-lived worker processes).
+    """
+    global _PARSER
+    if _PARSER is None:
+        _PARSER = CParser()
+    return _PARSER
+
+
 # ============================================================
 #   Main entry for parsing C files
 # ============================================================
 
-def parse_c_file(path: str, use_gcc: bool = False) -> c_ast.FileAST:
+def parse_c_file(path: str, use_gcc: bool = False, quote_dirs: Sequence[str] = ()) -> c_ast.FileAST:
     """
     Read a C source file, preprocess it, and parse into a pycparser AST.
 
@@ -211,6 +290,7 @@ def parse_c_file(path: str, use_gcc: bool = False) -> c_ast.FileAST:
         path    : Path to a .c file.
         use_gcc : If True, use GCC (-E -P) as a real preprocessor.
                   If False, use the lightweight regex-based preprocessing.
+        quote_dirs : GCC mode only: extra -iquote include directories.
 
     Steps (lightweight mode):
         - Read the raw .c file.
@@ -228,12 +308,29 @@ def parse_c_file(path: str, use_gcc: bool = False) -> c_ast.FileAST:
         pycparser.c_ast.FileAST representing the translation unit.
     """
     if use_gcc:
-        cleaned_code = preprocess_with_gcc(path)
+        cleaned_code = preprocess_with_gcc(path, quote_dirs)
         cleaned_code = sanitize_gcc_output_for_pycparser(cleaned_code)
     else:
         with open(path, "r", encoding="utf-8") as f:
             code = f.read()
         cleaned_code = preprocess_code_for_pycparser(code)
 
-    parser = CParser()
-    return parser.parse(cleaned_code, filename=path)
+    return get_parser().parse(cleaned_code, filename=path)
+
+
+def parse_c_text(code: str, path: str) -> c_ast.FileAST:
+    """
+    parse_c_file() (lightweight mode) for source already in memory, e.g. a
+    blob read from git. Produces exactly the AST parse_c_file() would.
+    """
+    return get_parser().parse(preprocess_code_for_pycparser(code), filename=path)
+
+
+def parse_c_source(code: str, path: str = "<buffer>") -> c_ast.FileAST:
+    """
+    Parse in-memory C source (e.g. an unsaved editor buffer) with the
+    lightweight preprocessing. Unlike parse_c_file(), node coordinates are the
+    line numbers of the original text, comments and directives included.
+    """
+    cleaned_code = inject_fake_typedefs(line_marker(1, path) + preprocess_code_preserving_lines(code))
+    return get_parser().parse(cleaned_code, filename=path)
@@ -0,0 +1,324 @@
+"""
+pipeline.py – In-process analysis as overlapped, bounded-queue stages
+
+    discover/read ──q──> preprocess (xN) ──q──> parse + rules ──q──> emit
+
+Each stage runs in its own thread(s) and hands work on through a bounded
+queue, so disk reads and gcc subprocess waits (both release the GIL) overlap
+with the CPU-bound parsing and rule evaluation, and with report writing in
+the consumer. In GCC mode several preprocess threads keep several gcc
+processes running at once. Parsing stays on one thread: the CParser
+instance is not thread-safe.
+
+Results are yielded in input order, with the same content as iter_analyze(),
+so output and reports do not change. Errors surface at their file's turn,
+like in a serial run.
+
+Every stage records busy time and the time spent waiting for input
+(starved) or for room downstream (blocked); every queue its time-weighted
+mean and maximum length. PipelineStats.to_dict() goes into the "run" block
+of the JSON report, for tuning queue sizes.
+"""
+
+from __future__ import annotations
+
+import io
+import queue
+import threading
+import time
+from contextlib import nullcontext
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Tuple
+
+from .metrics import FunctionMetrics
+from .parser import (
+    get_parser,
+    preprocess_code_for_pycparser,
+    preprocess_with_gcc,
+    sanitize_gcc_output_for_pycparser,
+)
+from .rule_engine import Violation, run_rules
+from .scheduler import RunStats
+
+DEFAULT_QUEUE_SIZE = 8
+
+_DONE = object()  # end-of-stream marker, one per consumer thread
+
+
+# ---------- instrumented queue / stage bookkeeping ----------
+
+class StageQueue:
+    """queue.Queue with time-weighted occupancy accounting."""
+
+    def __init__(self, name: str, maxsize: int):
+        self.name = name
+        self.maxsize = maxsize
+        self._q: "queue.Queue" = queue.Queue(maxsize)
+        self._lock = threading.Lock()
+        self._len = 0
+        self._area = 0.0
+        self._last = time.perf_counter()
+        self.max_len = 0
+
+    def _account(self, delta: int):
+        with self._lock:
+            now = time.perf_counter()
+            self._area += self._len * (now - self._last)
+            self._last = now
+            self._len += delta
+            self.max_len = max(self.max_len, self._len)
+
+    def put(self, item) -> float:
+        """Enqueue; return the seconds spent blocked on a full queue."""
+        t0 = time.perf_counter()
+        self._q.put(item)
+        waited = time.perf_counter() - t0
+        self._account(+1)
+        return waited
+
+    def get(self) -> Tuple[Any, float]:
+        """Dequeue; return (item, seconds spent waiting on an empty queue)."""
+        t0 = time.perf_counter()
+        item = self._q.get()
+        waited = time.perf_counter() - t0
+        self._account(-1)
+        return item, waited
+
+    def to_dict(self, wall: float) -> Dict[str, Any]:
+        self._account(0)
+        return {
+            "capacity": self.maxsize,
+            "mean_length": round(self._area / wall, 2) if wall > 0 else 0.0,
+            "max_length": self.max_len,
+        }
+
+
+class StageStats:
+    def __init__(self, name: str, threads: int):
+        self.name = name
+        self.threads = threads
+        self.items = 0
+        self.busy = 0.0
+        self.starved = 0.0
+        self.blocked = 0.0
+        self._lock = threading.Lock()
+
+    def add(self, busy: float = 0.0, starved: float = 0.0, blocked: float = 0.0, items: int = 0):
+        with self._lock:
+            self.busy += busy
+            self.starved += starved
+            self.blocked += blocked
+            self.items += items
+
+    def to_dict(self, wall: float) -> Dict[str, Any]:
+        capacity = wall * self.threads
+        return {
+            "threads": self.threads,
+            "items": self.items,
+            "busy_seconds": round(self.busy, 3),
+            "starved_seconds": round(self.starved, 3),
+            "blocked_seconds": round(self.blocked, 3),
+            "utilization": round(min(self.busy / capacity, 1.0), 3) if capacity > 0 else 0.0,
+        }
+
+
+class PipelineStats:
+    def __init__(self, stages: List[StageStats], queues: List[StageQueue]):
+        self.stages = stages
+        self.queues = queues
+        self.wall_seconds = 0.0
+
+    def to_dict(self) -> Dict[str, Any]:
+        wall = self.wall_seconds
+        return {
+            "stages": {s.name: s.to_dict(wall) for s in self.stages},
+            "queues": {q.name: q.to_dict(wall) for q in self.queues},
+        }
+
+    def summary_lines(self) -> List[str]:
+        wall = self.wall_seconds
+        lines = []
+        for s in self.stages:
+            d = s.to_dict(wall)
+            lines.append(f"  {s.name:<11} x{s.threads:<3}: {d['utilization']:.0%} busy, "
+                         f"starved {d['starved_seconds']:.2f}s, blocked {d['blocked_seconds']:.2f}s")
+        for q in self.queues:
+            d = q.to_dict(wall)
+            lines.append(f"  queue {q.name:<17}: mean {d['mean_length']:.1f} / "
+                         f"max {d['max_length']} of {d['capacity']}")
+        return lines
+
+
+# ---------- stages ----------
+
+class _Item:
+    __slots__ = ("index", "path", "text", "cleaned", "violations", "metrics", "error", "seconds")
+
+    def __init__(self, index: int, path: str):
+        self.index = index
+        self.path = path
+        self.text: Optional[str] = None
+        self.cleaned: Optional[str] = None
+        self.violations: Optional[List[Violation]] = None
+        self.metrics: Optional[List[FunctionMetrics]] = None
+        self.error: Optional[BaseException] = None
+        self.seconds = 0.0
+
+
+def iter_pipeline(
+    paths: Iterable[str],
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    want_metrics: bool = False,
+    queue_size: int = DEFAULT_QUEUE_SIZE,
+    preprocess_threads: int = 1,
+    stats: Optional[RunStats] = None,
+    jobserver=None,
+) -> Iterator[Tuple[str, List[Violation], Optional[List[FunctionMetrics]]]]:
+    """
+    Yield (path, violations, metrics) in input order, like iter_analyze().
+
+    With a make jobserver every gcc run holds a token, so at most as many
+    run at once as make has slots free (whatever preprocess_threads is).
+    """
+    stats = stats or RunStats()
+    preprocess_threads = max(1, preprocess_threads)
+
+    read_q = StageQueue("read->preprocess", queue_size)
+    parse_q = StageQueue("preprocess->parse", queue_size)
+    emit_q = StageQueue("parse->emit", queue_size)
+    s_read = StageStats("read", 1)
+    s_pre = StageStats("preprocess", preprocess_threads)
+    s_parse = StageStats("parse+rules", 1)
+    s_emit = StageStats("emit", 1)
+    pstats = PipelineStats([s_read, s_pre, s_parse, s_emit], [read_q, parse_q, emit_q])
+    stop = threading.Event()
+
+    def read_stage():
+        index = 0
+        try:
+            t0 = time.perf_counter()
+            for path in paths:  # discovery is I/O as well
+                if stop.is_set():
+                    break
+                item = _Item(index, path)
+                try:
+                    with open(path, "r", encoding="utf-8") as f:
+                        item.text = f.read()
+                except Exception as e:  # reported at this file's turn
+                    item.error = e
+                busy = time.perf_counter() - t0
+                s_read.add(busy=busy, blocked=read_q.put(item), items=1)
+                index += 1
+                t0 = time.perf_counter()
+        except Exception as e:
+            # The input stream itself failed (e.g. discovery): reported after
+            # the files read so far, the same way as a per-file error
+            item = _Item(index, "<input>")
+            item.error = e
+            read_q.put(item)
+        finally:
+            # Always end the stream, or the preprocess threads wait forever
+            for _ in range(preprocess_threads):
+                read_q.put(_DONE)
+
+    def preprocess_stage():
+        while True:
+            item, starved = read_q.get()
+            if item is _DONE:
+                parse_q.put(_DONE)
+                return
+            t0 = time.perf_counter()
+            if item.error is None and not stop.is_set():
+                try:
+                    if use_gcc:
+                        with jobserver.token() if jobserver else nullcontext():
+                            code = preprocess_with_gcc(item.path)
+                        item.cleaned = sanitize_gcc_output_for_pycparser(code)
+                    else:
+                        item.cleaned = preprocess_code_for_pycparser(item.text)
+                except Exception as e:
+                    item.error = e
+            busy = time.perf_counter() - t0
+            item.seconds += busy
+            s_pre.add(busy=busy, starved=starved, blocked=parse_q.put(item), items=1)
+
+    def parse_stage():
+        # Preprocess threads finish out of order; restore input order here
+        pending: Dict[int, _Item] = {}
+        next_index = 0
+        done = 0
+        while done < preprocess_threads:
+            item, starved = parse_q.get()
+            s_parse.add(starved=starved)
+            if item is _DONE:
+                done += 1
+                continue
+            pending[item.index] = item
+            while next_index in pending:
+                ready = pending.pop(next_index)
+                next_index += 1
+                t0 = time.perf_counter()
+                if ready.error is None and not stop.is_set():
+                    try:
+                        ast = get_parser().parse(ready.cleaned, filename=ready.path)
+                        ready.metrics = [] if want_metrics else None
+                        file_lines = io.StringIO(ready.text).readlines()
+                        ready.violations = run_rules(
+                            ast, rules, ready.path, metrics=ready.metrics, file_lines=file_lines
+                        )
+                    except Exception as e:
+                        ready.error = e
+                ready.cleaned = ready.text = None  # free memory early
+                busy = time.perf_counter() - t0
+                ready.seconds += busy
+                s_parse.add(busy=busy, blocked=emit_q.put(ready), items=1)
+        emit_q.put(_DONE)
+
+    def guarded(stage):
+        def run():
+            try:
+                stage()
+            except BaseException as e:  # keep the consumer from waiting forever
+                emit_q.put(e)
+        return run
+
+    threads = [threading.Thread(target=guarded(read_stage), name="complyc-read", daemon=True)]
+    threads += [
+        threading.Thread(target=guarded(preprocess_stage), name=f"complyc-pre{i}", daemon=True)
+        for i in range(preprocess_threads)
+    ]
+    threads.append(threading.Thread(target=guarded(parse_stage), name="complyc-parse", daemon=True))
+
+    start = time.perf_counter()
+    for t in threads:
+        t.start()
+    stats.worker_busy = [0.0]
+    try:
+        while True:
+            item, starved = emit_q.get()
+            if item is _DONE:
+                break
+            if isinstance(item, BaseException):
+                raise item
+            s_emit.add(starved=starved)
+            if item.error is not None:
+                raise item.error
+            stats.file_seconds[item.path] = item.seconds
+            stats.worker_busy[0] += item.seconds
+            if item.seconds >= stats.critical_seconds:
+                stats.critical_file, stats.critical_seconds = item.path, item.seconds
+            t0 = time.perf_counter()
+            yield item.path, item.violations, item.metrics  # the consumer's work is "emit"
+            s_emit.add(busy=time.perf_counter() - t0, items=1)
+    finally:
+        # On an error (or an abandoned generator) let the stages drain quickly
+        stop.set()
+        while any(t.is_alive() for t in threads):
+            try:
+                emit_q._q.get(timeout=0.05)
+            except queue.Empty:
+                pass
+        stats.wall_seconds = pstats.wall_seconds = time.perf_counter() - start
+        stats.pipeline = pstats
+        if jobserver is not None:
+            stats.jobserver_peak = jobserver.peak_jobs
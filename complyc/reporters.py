@@ -1,15 +1,21 @@
 """
 reporters.py – JSON and HTML report generators for ComplyC
+
+Reporters accept either a {path: [Violation]} dict or a ResultSpill (see
+spill.py); the latter is consumed as a stream, file by file.
 """
 
 from __future__ import annotations
 
 import json
 import html
+import os
 from dataclasses import asdict
-from typing import Dict, List
+from typing import TYPE_CHECKING, Any, Dict, Iterable, List, Optional, TextIO, Tuple, Union
 
-from .rule_engine import Violation
+if TYPE_CHECKING:
+    from .rule_engine import Violation
+    from .spill import ResultSpill
 
 
 def violations_to_dict(per_file: Dict[str, List[Violation]]):
@@ -47,17 +53,196 @@ def violations_to_dict(per_file: Dict[str, List[Violation]]):
     return data
 
 
-def write_json_report(per_file: Dict[str, List[Violation]], outfile: str):
-    """Write a JSON report to outfile."""
-    data = violations_to_dict(per_file)
+def report_source(
+    per_file: Union[Dict[str, List[Violation]], ResultSpill],
+) -> Tuple[Iterable[Dict[str, Any]], Dict[str, Any]]:
+    """(file entries, summary) of a results dict or a ResultSpill."""
+    if isinstance(per_file, dict):
+        data = violations_to_dict(per_file)
+        return data["files"], data["summary"]
+    return per_file.iter_entries(), per_file.summary()
+
+
+def _indented(value: Any, prefix: str) -> str:
+    """json.dumps(indent=2) re-indented as if nested, matching json.dump(indent=2)."""
+    return json.dumps(value, indent=2).replace("\n", "\n" + prefix)
+
+
+class JsonReportWriter:
+    """
+    Incremental writer of a report object ({**head, "files", "summary",
+    **tail}): file entries are written as they complete, the summary is
+    counted on the way and written as a trailer by finish(). The output is
+    byte-identical to json.dump(..., indent=2) of the whole object, and
+    memory does not grow with the number of files or violations.
+    """
+
+    def __init__(self, out: TextIO, head: Optional[Dict[str, Any]] = None):
+        self.out = out
+        self.total_files = 0
+        self.total_violations = 0
+        self.by_severity: Dict[str, int] = {}
+        out.write("{\n")
+        for key, value in (head or {}).items():
+            out.write(f"  {json.dumps(key)}: {_indented(value, '  ')},\n")
+        out.write('  "files": [')
+
+    def add_entry(self, entry: Dict[str, Any]):
+        """One {"file", "violations"} entry with violations as dicts."""
+        self.out.write(",\n    " if self.total_files else "\n    ")
+        self.out.write(_indented({"file": entry["file"], "violations": entry["violations"]}, "    "))
+        self.total_files += 1
+        for v in entry["violations"]:
+            self.total_violations += 1
+            sev = v.get("severity") or "unspecified"
+            self.by_severity[sev] = self.by_severity.get(sev, 0) + 1
+
+    def add(self, path: str, violations: Iterable[Violation]):
+        self.add_entry({"file": path, "violations": [asdict(v) for v in violations]})
+
+    def summary(self) -> Dict[str, Any]:
+        return {
+            "total_files": self.total_files,
+            "total_violations": self.total_violations,
+            "by_severity": dict(self.by_severity),
+        }
+
+    def finish(self, tail: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        """Close the file array, write the summary trailer (and tail); return the summary."""
+        summary = self.summary()
+        self.out.write("\n  ]" if self.total_files else "]")
+        self.out.write(',\n  "summary": ' + _indented(summary, "  "))
+        for key, value in (tail or {}).items():
+            self.out.write(f",\n  {json.dumps(key)}: {_indented(value, '  ')}")
+        self.out.write("\n}")
+        return summary
+
+
+def write_json_stream(
+    out: TextIO,
+    entries: Iterable[Dict[str, Any]],
+    head: Optional[Dict[str, Any]] = None,
+    tail: Optional[Dict[str, Any]] = None,
+) -> Dict[str, Any]:
+    """
+    Write a report object from an iterable of file entries (see
+    JsonReportWriter); the summary is returned.
+    """
+    writer = JsonReportWriter(out, head)
+    for entry in entries:
+        writer.add_entry(entry)
+    return writer.finish(tail)
+
+
+def open_report(path: str, mode: str = "r", like: Optional[str] = None) -> TextIO:
+    """
+    Text stream of a JSON report, compressed according to the extension of
+    `like` (default: path): .gz (gzip) or .zst (zstd, needs the zstandard
+    package on Python < 3.14).
+    """
+    name = (like or path).lower()
+    if name.endswith(".gz"):
+        import gzip
+
+        return gzip.open(path, mode + "t", encoding="utf-8")
+    if name.endswith(".zst"):
+        try:
+            from compression import zstd  # Python 3.14+
+        except ImportError:
+            try:
+                import zstandard as zstd
+            except ImportError:
+                raise OSError(f"{like or path}: zstd compression needs the 'zstandard' package "
+                              f"(pip install zstandard) or Python 3.14")
+        return zstd.open(path, mode + "t", encoding="utf-8")
+    return open(path, mode, encoding="utf-8")
+
+
+def write_summary_file(path: str, report: str, summary: Dict[str, Any], tail: Optional[Dict[str, Any]] = None):
+    """The --json-summary file: the report's summary and tail blocks on their own."""
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump({"report": report, "summary": summary, **(tail or {})}, f, indent=2)
+    print(f"[ComplyC] JSON summary written to {path}")
+
+
+class JsonReportFile(JsonReportWriter):
+    """
+    A JSON report written while the run is going on. It is built in
+    <outfile>.partial (flushed per file unless compressed, so progress can
+    be followed) and
+    renamed to outfile by close(); an interrupted run leaves the partial
+    file behind and any previous report untouched. With summary_path the
+    summary (and tail blocks) are also written to a small separate file.
+    A .gz / .zst outfile is compressed (see open_report).
+    """
+
+    def __init__(self, outfile: str, head: Optional[Dict[str, Any]] = None, summary_path: Optional[str] = None):
+        self.outfile = outfile
+        self.summary_path = summary_path
+        self.partial = outfile + ".partial"
+        # Flushing a compressor per file would cost most of its ratio
+        self._flush = not outfile.lower().endswith((".gz", ".zst"))
+        super().__init__(open_report(self.partial, "w", like=outfile), head)
+
+    def add_entry(self, entry: Dict[str, Any]):
+        super().add_entry(entry)
+        if self._flush:
+            self.out.flush()
+
+    def close(self, tail: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        summary = self.finish(tail)
+        self.out.close()
+        os.replace(self.partial, self.outfile)
+        print(f"[ComplyC] JSON report written to {self.outfile}")
+        if self.summary_path:
+            write_summary_file(self.summary_path, self.outfile, summary, tail)
+        return summary
+
+
+def report_tail(
+    run_info: Optional[Dict[str, Any]] = None,
+    sample_info: Optional[Dict[str, Any]] = None,
+) -> Dict[str, Any]:
+    """The blocks after "summary": "run" for parallel runs, "sample" for --sample."""
+    tail = {}
+    if run_info:
+        tail["run"] = run_info
+    if sample_info:
+        tail["sample"] = sample_info
+    return tail
+
+
+def write_json_report(
+    per_file: Union[Dict[str, List[Violation]], ResultSpill],
+    outfile: str,
+    run_info: Optional[Dict[str, Any]] = None,
+    shard_info: Optional[Dict[str, Any]] = None,
+    sample_info: Optional[Dict[str, Any]] = None,
+):
+    """
+    Write a JSON report to outfile (with a "run" block for parallel runs and
+    a "sample" block with the estimates of a --sample run).
+
+    Shard reports start with a "shard" block, so `complyc merge` can read it
+    before streaming the files.
+    """
+    entries, _ = report_source(per_file)
+    head = {"shard": shard_info} if shard_info else None
+    tail = report_tail(run_info, sample_info)
     with open(outfile, "w", encoding="utf-8") as f:
-        json.dump(data, f, indent=2)
+        write_json_stream(f, entries, head=head, tail=tail)
     print(f"[ComplyC] JSON report written to {outfile}")
 
 
-def write_html_report(per_file: Dict[str, List[Violation]], outfile: str):
-    """Write a simple but clean HTML report."""
-    data = violations_to_dict(per_file)
+def write_html_report(
+    per_file: Union[Dict[str, List[Violation]], ResultSpill],
+    outfile: str,
+    run_info: Optional[Dict[str, Any]] = None,
+    shard_info: Optional[Dict[str, Any]] = None,
+    sample_info: Optional[Dict[str, Any]] = None,
+):
+    """Write a simple but clean HTML report (streamed out file by file)."""
+    entries, s = report_source(per_file)
 
     html_parts = []
     html_parts.append("<!DOCTYPE html>")
@@ -93,9 +278,11 @@ h1, h2 { color: #333; }
     html_parts.append("<h1>ComplyC – Coding Style Report</h1>")
 
     # Summary section
-    s = data["summary"]
     html_parts.append("<h2>Summary</h2>")
     html_parts.append("<table class='summary-table'>")
+    if shard_info:
+        html_parts.append("<tr><th>Shard</th><td>{}/{} ({} of {} files)</td></tr>".format(
+            shard_info["index"], shard_info["count"], s["total_files"], shard_info["total_files"]))
     html_parts.append("<tr><th>Total files</th><td>{}</td></tr>".format(s["total_files"]))
     html_parts.append("<tr><th>Total violations</th><td>{}</td></tr>".format(s["total_violations"]))
     html_parts.append("<tr><th>Violations by severity</th><td><ul>")
@@ -103,43 +290,68 @@ h1, h2 { color: #333; }
         cls = f"severity-{sev.lower()}"
         html_parts.append(f"<li class='{cls}'>{html.escape(sev)}: {count}</li>")
     html_parts.append("</ul></td></tr>")
+    if run_info:
+        util = ", ".join(f"{u:.0%}" for u in run_info["worker_utilization"])
+        html_parts.append("<tr><th>Workers</th><td>{} (utilization: {})</td></tr>".format(
+            run_info["jobs"], util))
+        html_parts.append("<tr><th>Critical-path file</th><td>{} ({:.2f}s)</td></tr>".format(
+            html.escape(run_info["critical_path_file"] or ""), run_info["critical_path_seconds"]))
+    if sample_info:
+        est = sample_info["estimated_violations"]
+        html_parts.append("<tr><th>Sample</th><td>{} of {} files, seed {}</td></tr>".format(
+            sample_info["analyzed"], sample_info["population"], sample_info["seed"]))
+        html_parts.append("<tr><th>Estimated violations</th><td>{:.0f} ({:.0%} CI {:.0f}&ndash;{:.0f})"
+                          "</td></tr>".format(est["total"], sample_info["confidence"], est["low"], est["high"]))
     html_parts.append("</table>")
 
-    # Per-file section
-    for file_entry in data["files"]:
-        file_path = file_entry["file"]
-        violations = file_entry["violations"]
+    if sample_info:
+        html_parts.append("<h2>Estimated Violations per Rule</h2>")
+        html_parts.append("<table class='summary-table'>")
+        html_parts.append("<tr><th>Rule</th><th>Per file</th><th>Estimated total</th>"
+                          "<th>{:.0%} CI</th></tr>".format(sample_info["confidence"]))
+        for r in sample_info["by_rule"]:
+            html_parts.append("<tr><td>{}</td><td>{:.3f}</td><td>{:.0f}</td><td>{:.0f}&ndash;{:.0f}</td></tr>".format(
+                html.escape(r["rule_id"]), r["per_file"], r["total"], r["low"], r["high"]))
+        html_parts.append("</table>")
 
-        html_parts.append(f"<div class='file-header'><h2>File: {html.escape(file_path)}</h2>")
-        html_parts.append(f"<p>Total violations: {len(violations)}</p></div>")
+    with open(outfile, "w", encoding="utf-8") as f:
+        f.write("\n".join(html_parts))
 
-        if not violations:
-            html_parts.append("<p>No violations ✅</p>")
-            continue
+        # Per-file section
+        for file_entry in entries:
+            file_path = file_entry["file"]
+            violations = file_entry["violations"]
+            html_parts = []
 
-        html_parts.append("<table class='violations-table'>")
-        html_parts.append("<tr><th>Line</th><th>Rule ID</th><th>Severity</th><th>Message</th><th>Reference</th></tr>")
-        for v in violations:
-            line = v.get("line") or ""
-            rule_id = html.escape(v.get("rule_id", ""))
-            msg = html.escape(v.get("message", ""))
-            sev = v.get("severity") or "unspecified"
-            ref = html.escape(v.get("reference") or "")
-            sev_class = f"severity-{sev.lower()}"
-            html_parts.append(
-                f"<tr>"
-                f"<td>{line}</td>"
-                f"<td>{rule_id}</td>"
-                f"<td class='{sev_class}'>{html.escape(sev)}</td>"
-                f"<td>{msg}</td>"
-                f"<td>{ref}</td>"
-                f"</tr>"
-            )
-        html_parts.append("</table>")
+            html_parts.append(f"<div class='file-header'><h2>File: {html.escape(file_path)}</h2>")
+            html_parts.append(f"<p>Total violations: {len(violations)}</p></div>")
 
-    html_parts.append("</body></html>")
+            if not violations:
+                html_parts.append("<p>No violations ✅</p>")
+                f.write("\n" + "\n".join(html_parts))
+                continue
 
-    with open(outfile, "w", encoding="utf-8") as f:
-        f.write("\n".join(html_parts))
+            html_parts.append("<table class='violations-table'>")
+            html_parts.append("<tr><th>Line</th><th>Rule ID</th><th>Severity</th><th>Message</th><th>Reference</th></tr>")
+            for v in violations:
+                line = v.get("line") or ""
+                rule_id = html.escape(v.get("rule_id", ""))
+                msg = html.escape(v.get("message", ""))
+                sev = v.get("severity") or "unspecified"
+                ref = html.escape(v.get("reference") or "")
+                sev_class = f"severity-{sev.lower()}"
+                html_parts.append(
+                    f"<tr>"
+                    f"<td>{line}</td>"
+                    f"<td>{rule_id}</td>"
+                    f"<td class='{sev_class}'>{html.escape(sev)}</td>"
+                    f"<td>{msg}</td>"
+                    f"<td>{ref}</td>"
+                    f"</tr>"
+                )
+            html_parts.append("</table>")
+            f.write("\n" + "\n".join(html_parts))
+
+        f.write("\n</body></html>")
 
     print(f"[ComplyC] HTML report written to {outfile}")
@@ -10,6 +10,9 @@ from typing import Any, Callable, Dict, List, Optional, Tuple
 
 from pycparser import c_ast
 
+from .console import warn
+from .metrics import FunctionMetrics, function_metrics
+
 
 @dataclass
 class Violation:
@@ -212,20 +215,14 @@ def check_global_naming(node, rule, ctx) -> List[Violation]:
 def check_max_function_length(node: c_ast.FuncDef, rule, ctx) -> List[Violation]:
     if not node.coord:
         return []
-    start = node.coord.line
-    end = start
-    if node.body and getattr(node.body, "block_items", None):
-        last = node.body.block_items[-1]
-        if last and last.coord:
-            end = last.coord.line
-    length = end - start + 1
+    m = function_metrics(node, ctx)
     max_lines = rule.get("max_lines", 40)
-    if length > max_lines:
+    if m.loc > max_lines:
         return [Violation(
             rule_id=rule["id"],
-            message=f"Function '{node.decl.name}' has {length} lines (max {max_lines}). {rule.get('guidance', '')}",
+            message=f"Function '{node.decl.name}' has {m.loc} lines (max {max_lines}). {rule.get('guidance', '')}",
             file=ctx["file_path"],
-            line=start,
+            line=m.line,
             severity=rule.get("severity"),
             reference=rule.get("reference"),
         )]
@@ -233,23 +230,17 @@ def check_max_function_length(node: c_ast.FuncDef, rule, ctx) -> List[Violation]
 
 
 def check_max_parameter_count(node: c_ast.FuncDef, rule, ctx) -> List[Violation]:
-    func_type = node.decl.type
-    while hasattr(func_type, "type") and not isinstance(func_type, c_ast.FuncDecl):
-        func_type = func_type.type
-
-    if isinstance(func_type, c_ast.FuncDecl):
-        params = getattr(func_type.args, "params", []) or []
-        count = len(params)
-        max_params = rule.get("max_parameters", 6)
-        if count > max_params:
-            return [Violation(
-                rule_id=rule["id"],
-                message=f"Function '{node.decl.name}' has {count} parameters (max {max_params}). {rule.get('guidance', '')}",
-                file=ctx["file_path"],
-                line=node.coord.line if node.coord else None,
-                severity=rule.get("severity"),
-                reference=rule.get("reference"),
-            )]
+    m = function_metrics(node, ctx)
+    max_params = rule.get("max_parameters", 6)
+    if m.parameters > max_params:
+        return [Violation(
+            rule_id=rule["id"],
+            message=f"Function '{node.decl.name}' has {m.parameters} parameters (max {max_params}). {rule.get('guidance', '')}",
+            file=ctx["file_path"],
+            line=m.line,
+            severity=rule.get("severity"),
+            reference=rule.get("reference"),
+        )]
     return []
 
 
@@ -288,39 +279,14 @@ def check_file_header_contains(node, rule, ctx) -> List[Violation]:
 
 
 def check_max_cyclomatic_complexity(node: c_ast.FuncDef, rule, ctx) -> List[Violation]:
-    class CCVisitor(c_ast.NodeVisitor):
-        def __init__(self):
-            self.cc = 1
-
-        def visit_If(self, n):
-            self.cc += 1
-            self.generic_visit(n)
-
-        def visit_For(self, n):
-            self.cc += 1
-            self.generic_visit(n)
-
-        def visit_While(self, n):
-            self.cc += 1
-            self.generic_visit(n)
-
-        def visit_Case(self, n):
-            self.cc += 1
-            self.generic_visit(n)
-
-        def visit_Default(self, n):
-            self.cc += 1
-            self.generic_visit(n)
-
-    v = CCVisitor()
-    v.visit(node)
+    m = function_metrics(node, ctx)
     max_cc = rule.get("max_cc", 10)
-    if v.cc > max_cc:
+    if m.cyclomatic_complexity > max_cc:
         return [Violation(
             rule_id=rule["id"],
-            message=f"Function '{node.decl.name}' has CC={v.cc} (max {max_cc}). {rule.get('guidance', '')}",
+            message=f"Function '{node.decl.name}' has CC={m.cyclomatic_complexity} (max {max_cc}). {rule.get('guidance', '')}",
             file=ctx["file_path"],
-            line=node.coord.line if node.coord else None,
+            line=m.line,
             severity=rule.get("severity"),
             reference=rule.get("reference"),
         )]
@@ -328,47 +294,14 @@ def check_max_cyclomatic_complexity(node: c_ast.FuncDef, rule, ctx) -> List[Viol
 
 
 def check_max_nesting_depth(node: c_ast.FuncDef, rule, ctx) -> List[Violation]:
-    class NestVisitor(c_ast.NodeVisitor):
-        def __init__(self):
-            self.max_depth = 0
-            self.current = 0
-
-        def _enter(self):
-            self.current += 1
-            self.max_depth = max(self.max_depth, self.current)
-
-        def _exit(self):
-            self.current -= 1
-
-        def visit_If(self, n):
-            self._enter()
-            self.generic_visit(n)
-            self._exit()
-
-        def visit_For(self, n):
-            self._enter()
-            self.generic_visit(n)
-            self._exit()
-
-        def visit_While(self, n):
-            self._enter()
-            self.generic_visit(n)
-            self._exit()
-
-        def visit_Switch(self, n):
-            self._enter()
-            self.generic_visit(n)
-            self._exit()
-
-    v = NestVisitor()
-    v.visit(node)
+    m = function_metrics(node, ctx)
     max_depth = rule.get("max_depth", 4)
-    if v.max_depth > max_depth:
+    if m.max_nesting > max_depth:
         return [Violation(
             rule_id=rule["id"],
-            message=f"Function '{node.decl.name}' nesting depth={v.max_depth} (max {max_depth}). {rule.get('guidance', '')}",
+            message=f"Function '{node.decl.name}' nesting depth={m.max_nesting} (max {max_depth}). {rule.get('guidance', '')}",
             file=ctx["file_path"],
-            line=node.coord.line if node.coord else None,
+            line=m.line,
             severity=rule.get("severity"),
             reference=rule.get("reference"),
         )]
@@ -493,9 +426,26 @@ CHECK_HANDLERS: Dict[str, Callable[[Any, Dict[str, Any], Dict[str, Any]], List[V
 
 # ---------- main entry ----------
 
-def run_rules(ast: c_ast.FileAST, rules: List[Dict[str, Any]], file_path: str) -> List[Violation]:
-    with open(file_path, "r", encoding="utf-8") as f:
-        file_lines = f.readlines()
+def run_rules(
+    ast: c_ast.FileAST,
+    rules: List[Dict[str, Any]],
+    file_path: str,
+    metrics: Optional[List[FunctionMetrics]] = None,
+    file_lines: Optional[List[str]] = None,
+) -> List[Violation]:
+    """
+    Evaluate all rules against one parsed file.
+
+    If a metrics list is given, per-function metrics for every FuncDef are
+    appended to it. They come from the same cache the function-scope checks
+    use, so requesting them costs no extra traversal for those functions.
+
+    file_lines (the raw source, as from readlines()) is read from file_path
+    unless given, e.g. for sources that only exist in memory.
+    """
+    if file_lines is None:
+        with open(file_path, "r", encoding="utf-8") as f:
+            file_lines = f.readlines()
 
     parent_map = build_parent_map(ast)
 
@@ -503,6 +453,7 @@ def run_rules(ast: c_ast.FileAST, rules: List[Dict[str, Any]], file_path: str) -
         "file_path": file_path,
         "file_lines": file_lines,
         "parent_map": parent_map,
+        "metrics_cache": {},
     }
 
     all_violations: List[Violation] = []
@@ -521,8 +472,12 @@ def run_rules(ast: c_ast.FileAST, rules: List[Dict[str, Any]], file_path: str) -
             try:
                 vio = handler(node, rule, ctx)
             except Exception as e:
-                print(f"[ComplyC] Error in rule {rule.get('id')}: {e}")
+                warn(f"Error in rule {rule.get('id')}: {e}")
                 vio = []
             all_violations.extend(vio)
 
+    if metrics is not None:
+        for node, _ in iter_nodes_by_scope(ast, "function"):
+            metrics.append(function_metrics(node, ctx_base))
+
     return all_violations
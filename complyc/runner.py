@@ -0,0 +1,265 @@
+"""
+runner.py – Per-file analysis orchestration for ComplyC
+
+Runs the parse + rule pipeline for a list of files, either serially in this
+process or on worker processes driven by scheduler.py. Workers receive the
+rules once and keep a warm parser; they send back only compact tuples, never
+ASTs. Results are always yielded in input order, so a parallel run produces
+exactly the same output and reports as a serial run.
+"""
+
+from __future__ import annotations
+
+import io
+import os
+import time
+from collections import OrderedDict, deque
+from dataclasses import astuple
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Sequence, Tuple
+
+from .includes import include_closure
+from .metrics import FunctionMetrics
+from .parser import parse_c_file, parse_c_text
+from .rule_engine import Violation, run_rules
+from .scheduler import RunStats, TimingStore, run_scheduled
+
+
+# ---------- compact wire format ----------
+
+def violation_to_tuple(v: Violation) -> tuple:
+    return astuple(v)
+
+
+def tuple_to_violation(t: tuple) -> Violation:
+    return Violation(*t)
+
+
+def metrics_to_tuple(m: FunctionMetrics) -> tuple:
+    return astuple(m)
+
+
+def tuple_to_metrics(t: tuple) -> FunctionMetrics:
+    return FunctionMetrics(*t)
+
+
+# ---------- single-file analysis ----------
+
+def analyze_file(
+    path: str,
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    metrics: Optional[List[FunctionMetrics]] = None,
+) -> List[Violation]:
+    """Parse one file and evaluate all rules against it."""
+    if _memo is not None:
+        return _memo.analyze(path, rules, use_gcc, metrics)
+    ast = parse_c_file(path, use_gcc=use_gcc)
+    return run_rules(ast, rules, path, metrics=metrics)
+
+
+def analyze_source(
+    path: str,
+    text: str,
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    metrics: Optional[List[FunctionMetrics]] = None,
+    gcc_path: Optional[str] = None,
+    quote_dirs: Sequence[str] = (),
+) -> List[Violation]:
+    """
+    analyze_file() for content that is not (or not as-is) on disk.
+
+    text must have universal newlines, as from a text-mode read. GCC mode
+    needs a file to preprocess: gcc_path, holding the same content, with
+    quote_dirs as extra -iquote directories (e.g. path's own directory).
+    """
+    if use_gcc:
+        ast = parse_c_file(gcc_path, use_gcc=True, quote_dirs=quote_dirs)
+    else:
+        ast = parse_c_text(text, path)
+    file_lines = io.StringIO(text).readlines()  # split like readlines(): on \n only
+    return run_rules(ast, rules, path, metrics=metrics, file_lines=file_lines)
+
+
+# ---------- in-memory result memo (long-lived processes) ----------
+
+def file_signature(path: str, use_gcc: bool) -> Optional[tuple]:
+    """
+    (path, mtime, size) of the file and, in GCC mode, of the headers it
+    includes: changes whenever the file's result may change. None if the
+    file cannot be stat'ed.
+    """
+    try:
+        st = os.stat(path)
+    except OSError:
+        return None
+    sig = [(os.path.abspath(path), st.st_mtime_ns, st.st_size)]
+    if use_gcc:
+        for header in sorted(include_closure(path)):
+            try:
+                hst = os.stat(header)
+            except OSError:
+                continue
+            sig.append((header, hst.st_mtime_ns, hst.st_size))
+    return tuple(sig)
+
+
+class ResultMemo:
+    """
+    LRU of per-file results keyed by (path, mtime, size) of the file and, in
+    GCC mode, of the headers it includes, plus the rules fingerprint (so a
+    reloaded rule list with the same content still hits).
+
+    Only worth it in processes that analyze the same files repeatedly (the
+    daemon); the CLI never enables it.
+    """
+
+    def __init__(self, max_entries: int = 20000):
+        self.max_entries = max_entries
+        self.entries: "OrderedDict[tuple, tuple]" = OrderedDict()
+        self._last_rules: Optional[Tuple[List[Dict[str, Any]], str]] = None
+        self.hits = 0
+        self.misses = 0
+
+    def _fingerprint(self, rules) -> str:
+        # Requests reuse one rule list for many files: fingerprint it once
+        if self._last_rules is None or self._last_rules[0] is not rules:
+            from .cache import rules_fingerprint  # the cache module only matters to the daemon
+
+            self._last_rules = (rules, rules_fingerprint(rules, False))
+        return self._last_rules[1]
+
+    def analyze(self, path, rules, use_gcc, metrics):
+        sig = file_signature(path, use_gcc)
+        key = (sig, self._fingerprint(rules), use_gcc, metrics is not None) if sig else None
+        if key is not None and key in self.entries:
+            self.hits += 1
+            self.entries.move_to_end(key)
+            v_tuples, m_tuples = self.entries[key]
+            # Re-attach the path as spelled by this caller
+            if metrics is not None:
+                metrics.extend(FunctionMetrics(path, *t[1:]) for t in m_tuples)
+            return [Violation(t[0], t[1], path, *t[3:]) for t in v_tuples]
+
+        self.misses += 1
+        ast = parse_c_file(path, use_gcc=use_gcc)
+        violations = run_rules(ast, rules, path, metrics=metrics)
+        if key is not None:
+            self.entries[key] = (
+                [violation_to_tuple(v) for v in violations],
+                [metrics_to_tuple(m) for m in metrics] if metrics is not None else None,
+            )
+            while len(self.entries) > self.max_entries:
+                self.entries.popitem(last=False)
+        return violations
+
+
+_memo: Optional[ResultMemo] = None
+
+
+def enable_result_memo(max_entries: int = 20000) -> ResultMemo:
+    global _memo
+    _memo = ResultMemo(max_entries)
+    return _memo
+
+
+# ---------- input order for completion-order runs ----------
+
+class InputOrder:
+    """
+    Puts results that arrive in completion order back into input order.
+
+    Paths are numbered as they pass through track(); add() takes one result
+    and returns the results that are now due, in input order. Completion
+    order is for the console only: reports stay in input order (and so do
+    not depend on timing).
+    """
+
+    def __init__(self):
+        self._positions: Dict[str, deque] = {}
+        self._count = 0
+        self._ready: Dict[int, tuple] = {}
+        self._next = 0
+
+    def track(self, paths: Iterable[str]) -> Iterator[str]:
+        for path in paths:
+            self._positions.setdefault(path, deque()).append(self._count)
+            self._count += 1
+            yield path
+
+    def add(self, path: str, *result) -> List[tuple]:
+        index = self._positions[path].popleft()
+        self._ready[index] = (path, *result)
+        due = []
+        while self._next in self._ready:
+            due.append(self._ready.pop(self._next))
+            self._next += 1
+        return due
+
+
+# ---------- public entry ----------
+
+def resolve_jobs(jobs: int) -> int:
+    """Map the -j value to a worker count (0 means 'all CPUs')."""
+    if jobs is None or jobs < 0:
+        return 1
+    if jobs == 0:
+        return os.cpu_count() or 1
+    return jobs
+
+
+def iter_analyze(
+    paths: Iterable[str],
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    jobs: int = 1,
+    want_metrics: bool = False,
+    timings: Optional[TimingStore] = None,
+    stats: Optional[RunStats] = None,
+    jobserver=None,
+    completion_order: bool = False,
+) -> Iterator[Tuple[str, List[Violation], Optional[List[FunctionMetrics]]]]:
+    """
+    Yield (path, violations, metrics) for every path, in input order
+    (in completion order with completion_order; see run_scheduled).
+
+    paths may be a lazy iterable (e.g. a discovery stream); it is consumed
+    incrementally, so the first results arrive before it is exhausted.
+
+    metrics is None unless want_metrics is set. Per-file timings are recorded
+    into stats (if given), and timings drives the cost-aware scheduling.
+    A make jobserver (jobserver.py) limits how many workers run at once.
+    """
+    jobs = resolve_jobs(jobs)
+    if isinstance(paths, (list, tuple)):
+        jobs = min(jobs, max(len(paths), 1))
+    timings = timings or TimingStore(None)
+    stats = stats or RunStats()
+
+    if jobs <= 1:
+        start = time.perf_counter()
+        paused = 0.0  # time the consumer spent between results (not ours)
+        stats.worker_busy = [0.0]
+        for path in paths:
+            t0 = time.perf_counter()
+            metrics = [] if want_metrics else None
+            violations = analyze_file(path, rules, use_gcc, metrics)
+            seconds = time.perf_counter() - t0
+            stats.file_seconds[path] = seconds
+            stats.worker_busy[0] += seconds
+            stats.critical_file, stats.critical_seconds = path, seconds
+            t0 = time.perf_counter()
+            yield path, violations, metrics
+            paused += time.perf_counter() - t0
+        stats.wall_seconds = time.perf_counter() - start - paused
+        return
+
+    for _, path, payload, error in run_scheduled(
+        paths, rules, use_gcc, jobs, want_metrics, timings, stats, jobserver, completion_order
+    ):
+        if error is not None:
+            raise error
+        v_tuples, m_tuples = payload
+        violations = [tuple_to_violation(t) for t in v_tuples]
+        metrics = [tuple_to_metrics(t) for t in m_tuples] if m_tuples is not None else None
+        yield path, violations, metrics
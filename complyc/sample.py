@@ -0,0 +1,385 @@
+"""
+sample.py – Statistical sampling for quick compliance estimates (`--sample`)
+
+`--sample N` (a file count) or `--sample 0.05` / `--sample 5%` (a fraction)
+analyzes a random sample of the discovered files instead of all of them and
+estimates what a full run would report:
+
+- Files are stratified by directory (the first level below the common root
+  that splits them) and by size class (small / medium / large tertiles), so
+  a handful of huge generated files or one big subsystem cannot dominate the
+  estimate by chance. Strata are merged when there are too many for the
+  sample size (size classes first, then the smallest directories).
+- Every stratum gets at least two files when the sample size allows, the
+  rest in proportion to its file count (never more than N files).
+- Per rule, the total number of violations in the whole file set is
+  estimated with the stratified expansion estimator, with a normal-
+  approximation confidence interval including the finite-population
+  correction. A rule never seen in the sample gets the upper bound
+  -ln(1 - confidence) / n violations per file ("rule of three" at 95%).
+
+With `--sample-precision P` sampling continues in rounds until the interval
+of the overall violation total is within +-P of the estimate (relative; for
+a sample without any violation: until the upper bound is below P violations
+per file), or every file has been analyzed. The interval is only tested
+once every stratum has MIN_PER_STRATUM analyzed files (or no more files):
+later rounds top up the strata short of that first, the rest goes to the
+strata whose results vary most (Neyman allocation).
+
+The random seed is printed and stored in the report; `--sample-seed` repeats
+a sample exactly (for the same file list).
+"""
+
+from __future__ import annotations
+
+import argparse
+import math
+import os
+from collections import Counter
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Sequence, Tuple, Union
+
+from .discovery import norm_path
+
+SIZE_CLASSES = ("small", "medium", "large")
+
+# --sample-precision only trusts the interval once every stratum has this
+# many analyzed files (or is exhausted): from two or three files a stratum's
+# variance is often zero by chance, and the normal interval with it.
+MIN_PER_STRATUM = 5
+
+
+def parse_sample_spec(spec: str) -> Union[int, float]:
+    """'200' -> 200 files; '0.05' or '5%' -> 0.05 of the files."""
+    try:
+        if spec.endswith("%"):
+            value: Union[int, float] = float(spec[:-1]) / 100.0
+        elif spec.isdigit():
+            value = int(spec)
+        else:
+            value = float(spec)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"expected a file count, a fraction or a percentage, got {spec!r}")
+    if isinstance(value, int) and value < 1 or isinstance(value, float) and not 0.0 < value <= 1.0:
+        raise argparse.ArgumentTypeError(f"sample size must be >= 1 or within (0, 1], got {spec!r}")
+    return value
+
+
+def sample_size(spec: Union[int, float], population: int) -> int:
+    if isinstance(spec, int):
+        return min(spec, population)
+    return min(population, max(1, math.ceil(spec * population)))
+
+
+def _allocate(
+    n: int,
+    weights: Sequence[float],
+    capacity: Sequence[int],
+    floor: Union[int, Sequence[int]] = 0,
+) -> List[int]:
+    """
+    Split n draws over strata: `floor` (one for all, or per stratum) first,
+    the rest by weight (largest remainder). Never more than n in total: the
+    floors are lowered evenly when they do not fit.
+    """
+    floors = [floor] * len(capacity) if isinstance(floor, int) else list(floor)
+    alloc = [min(f, c) for f, c in zip(floors, capacity)]
+    while sum(alloc) > n:
+        h = max(range(len(alloc)), key=lambda h: (alloc[h], -h))
+        alloc[h] -= 1
+    n -= sum(alloc)
+    while n > 0:
+        open_ = [h for h, c in enumerate(capacity) if alloc[h] < c]
+        if not open_:
+            break
+        total = sum(weights[h] for h in open_)
+        if total <= 0:
+            total, share = len(open_), {h: n / len(open_) for h in open_}
+        else:
+            share = {h: n * weights[h] / total for h in open_}
+        given = 0
+        for h in open_:
+            k = min(int(share[h]), capacity[h] - alloc[h])
+            alloc[h] += k
+            given += k
+        if given == 0:
+            # Only fractions left: one draw to the largest remainder
+            h = max(open_, key=lambda h: (share[h] - int(share[h]), weights[h], -h))
+            alloc[h] += 1
+            given = 1
+        n -= given
+    return alloc
+
+
+class _Stratum:
+    def __init__(self, key: Tuple[str, str], paths: List[str]):
+        self.key = key
+        self.paths = paths           # shuffled; the first `drawn` are in the sample
+        self.drawn = 0
+        self.observed: List[Counter] = []   # per analyzed file: rule id -> count
+
+    @property
+    def size(self) -> int:
+        return len(self.paths)
+
+    def totals(self) -> List[int]:
+        return [sum(c.values()) for c in self.observed]
+
+
+def _variance(values: Sequence[float]) -> Optional[float]:
+    n = len(values)
+    if n < 2:
+        return None
+    mean = sum(values) / n
+    return sum((v - mean) ** 2 for v in values) / (n - 1)
+
+
+class StratifiedSample:
+    def __init__(
+        self,
+        paths: Sequence[str],
+        rule_ids: Sequence[str],
+        spec: Union[int, float],
+        seed: Optional[int] = None,
+        confidence: float = 0.95,
+    ):
+        import random
+        from statistics import NormalDist
+
+        self.population = len(paths)
+        self.rule_ids = list(rule_ids)
+        self.seed = seed if seed is not None else random.SystemRandom().randrange(1 << 31)
+        self.confidence = confidence
+        self.z = NormalDist().inv_cdf(0.5 + confidence / 2.0)
+        self._rng = random.Random(self.seed)
+        self._order = {p: i for i, p in enumerate(paths)}
+        self.initial = sample_size(spec, self.population)
+        self.strata = self._stratify(list(paths), self.initial)
+        self._by_path: Dict[str, _Stratum] = {}
+        self.rounds = 0
+
+    # ---------- strata ----------
+
+    @staticmethod
+    def _dir_key(paths: List[str]) -> Dict[str, str]:
+        """Directory group of every path: the shallowest level (up to 3) that splits them."""
+        dirs = {p: os.path.dirname(os.path.abspath(p)) for p in paths}
+        try:
+            root = os.path.commonpath(list(dirs.values())) if dirs else ""
+        except ValueError:  # different drives
+            root = ""
+        rel = {p: os.path.relpath(d, root).split(os.sep) if root else [d] for p, d in dirs.items()}
+        keys: Dict[str, str] = {}
+        for depth in (1, 2, 3):
+            keys = {p: "/".join(parts[:depth]) for p, parts in rel.items()}
+            if len(set(keys.values())) > 1:
+                break
+        return keys
+
+    def _stratify(self, paths: List[str], n: int) -> List[_Stratum]:
+        sizes = {}
+        for p in paths:
+            try:
+                sizes[p] = os.path.getsize(p)
+            except OSError:
+                sizes[p] = 0
+        ordered = sorted(sizes.values())
+        cuts = [ordered[len(ordered) // 3], ordered[2 * len(ordered) // 3]] if ordered else [0, 0]
+        size_class = {p: SIZE_CLASSES[(s > cuts[0]) + (s > cuts[1])] for p, s in sizes.items()}
+        directory = self._dir_key(paths)
+
+        # At least two draws per stratum are needed for its variance
+        max_strata = max(1, n // 2)
+        groups = self._group(paths, lambda p: (directory[p], size_class[p]))
+        if len(groups) > max_strata:
+            groups = self._group(paths, lambda p: (directory[p], "any"))
+        if len(groups) > max_strata:
+            keep = {k[0] for k, _ in sorted(groups.items(), key=lambda kv: (-len(kv[1]), kv[0]))[:max_strata - 1]}
+            groups = self._group(paths, lambda p: (directory[p] if directory[p] in keep else "(other)", "any"))
+
+        strata = []
+        for key in sorted(groups):
+            members = sorted(groups[key], key=norm_path)
+            self._rng.shuffle(members)
+            strata.append(_Stratum(key, members))
+        return strata
+
+    @staticmethod
+    def _group(paths, key) -> Dict[Tuple[str, str], List[str]]:
+        groups: Dict[Tuple[str, str], List[str]] = {}
+        for p in paths:
+            groups.setdefault(key(p), []).append(p)
+        return groups
+
+    # ---------- drawing ----------
+
+    @property
+    def drawn(self) -> int:
+        return sum(s.drawn for s in self.strata)
+
+    def draw(self, n: int) -> List[str]:
+        """The next n files of the sample, in discovery order."""
+        capacity = [s.size - s.drawn for s in self.strata]
+        if self.rounds == 0:
+            alloc = _allocate(n, [s.size for s in self.strata], capacity, floor=2)
+        else:
+            # Strata short of MIN_PER_STRATUM are topped up first (see precision_reached)
+            floors = [max(0, MIN_PER_STRATUM - s.drawn) for s in self.strata]
+            # Neyman: where results vary most (untried spread falls back to the pooled one)
+            pooled = self._pooled_variance([s.totals() for s in self.strata]) or 1.0
+            weights = []
+            for s in self.strata:
+                var = _variance(s.totals())
+                weights.append(s.size * math.sqrt(pooled if var is None else var))
+            if not any(w > 0 for w, c in zip(weights, capacity) if c):
+                weights = [s.size for s in self.strata]
+            alloc = _allocate(n, weights, capacity, floors)
+        batch = []
+        for s, k in zip(self.strata, alloc):
+            for p in s.paths[s.drawn:s.drawn + k]:
+                self._by_path[p] = s
+                batch.append(p)
+            s.drawn += k
+        self.rounds += 1
+        return sorted(batch, key=self._order.__getitem__)
+
+    def next_batch_size(self) -> int:
+        short = sum(max(0, min(MIN_PER_STRATUM, s.size) - s.drawn) for s in self.strata)
+        return max(len(self.strata), short, math.ceil(self.drawn / 2))
+
+    def record(self, path: str, violations: Iterable[Any]):
+        self._by_path[path].observed.append(Counter(v.rule_id for v in violations))
+
+    # ---------- estimation ----------
+
+    @staticmethod
+    def _pooled_variance(per_stratum: Sequence[Sequence[float]]) -> Optional[float]:
+        num = den = 0.0
+        for values in per_stratum:
+            var = _variance(values)
+            if var is not None:
+                num += var * (len(values) - 1)
+                den += len(values) - 1
+        return num / den if den else None
+
+    def _estimate(self, values: List[List[float]]) -> Tuple[float, float]:
+        """(estimated population total, standard error) from per-stratum observations."""
+        pooled = self._pooled_variance(values)
+        total = variance = 0.0
+        for s, obs in zip(self.strata, values):
+            n = len(obs)
+            if n == 0:
+                continue
+            total += s.size * sum(obs) / n
+            if n < s.size:
+                var = _variance(obs)
+                if var is None:
+                    var = pooled or 0.0
+                variance += s.size ** 2 * (1.0 - n / s.size) * var / n
+        return total, math.sqrt(variance)
+
+    @property
+    def analyzed(self) -> int:
+        return sum(len(s.observed) for s in self.strata)
+
+    def _zero_bound(self) -> float:
+        """Upper bound of violations per file for a rule never seen in the sample."""
+        n = self.analyzed
+        if n == 0 or n >= self.population:
+            return 0.0
+        return -math.log(1.0 - self.confidence) / n
+
+    def overall(self) -> Dict[str, float]:
+        total, se = self._estimate([s.totals() for s in self.strata])
+        half = self.z * se
+        return {
+            "total": total,
+            "low": max(0.0, total - half),
+            "high": total + half,
+            "relative_half_width": half / total if total else None,
+        }
+
+    def precision_reached(self, precision: float) -> bool:
+        if self.analyzed >= self.population:
+            return True
+        if any(len(s.observed) < min(MIN_PER_STRATUM, s.size) for s in self.strata):
+            return False
+        est = self.overall()
+        if est["total"] == 0:
+            return self._zero_bound() <= precision
+        return est["relative_half_width"] <= precision
+
+    def per_rule(self) -> List[Dict[str, Any]]:
+        seen = {r for s in self.strata for c in s.observed for r in c}
+        ids = self.rule_ids + sorted(seen - set(self.rule_ids))
+        out = []
+        for rule_id in ids:
+            total, se = self._estimate([[c[rule_id] for c in s.observed] for s in self.strata])
+            if rule_id in seen:
+                low, high = max(0.0, total - self.z * se), total + self.z * se
+            else:
+                low, high = 0.0, self._zero_bound() * self.population
+            out.append({
+                "rule_id": rule_id,
+                "per_file": total / self.population if self.population else 0.0,
+                "total": total,
+                "low": low,
+                "high": high,
+            })
+        return out
+
+    def to_dict(self) -> Dict[str, Any]:
+        """The "sample" block of the JSON report."""
+        rnd = lambda x: round(x, 3) if x is not None else None
+        overall = self.overall()
+        return {
+            "population": self.population,
+            "analyzed": self.analyzed,
+            "seed": self.seed,
+            "rounds": self.rounds,
+            "confidence": self.confidence,
+            "strata": [
+                {"directory": s.key[0], "size_class": s.key[1], "files": s.size, "analyzed": len(s.observed)}
+                for s in self.strata
+            ],
+            "estimated_violations": {k: rnd(v) for k, v in overall.items()},
+            "by_rule": [{k: rnd(v) if k != "rule_id" else v for k, v in r.items()} for r in self.per_rule()],
+        }
+
+    def summary_lines(self) -> List[str]:
+        overall = self.overall()
+        conf = f"{self.confidence:.0%}"
+        lines = [
+            f"Sample                 : {self.analyzed} of {self.population} file(s), "
+            f"{len(self.strata)} strata, {self.rounds} round(s) (seed {self.seed})",
+            f"Estimated violations   : {overall['total']:.0f} "
+            f"({conf} CI {overall['low']:.0f}-{overall['high']:.0f}"
+            + (f", +-{overall['relative_half_width']:.1%})" if overall["relative_half_width"] else ")"),
+            f"Estimated per rule     : per file, total ({conf} CI)",
+        ]
+        for r in self.per_rule():
+            lines.append(f"  - {r['rule_id']:20} : {r['per_file']:.3f}, "
+                         f"{r['total']:.0f} ({r['low']:.0f}-{r['high']:.0f})")
+        return lines
+
+
+def iter_sample(
+    sample: StratifiedSample,
+    analyze,
+    precision: Optional[float] = None,
+) -> Iterator[Tuple[str, list, Optional[list]]]:
+    """
+    Run analyze() on the sample round by round, recording every result
+    before it is yielded; without a precision target there is one round.
+    """
+    batch = sample.draw(sample.initial)
+    while batch:
+        for path, violations, metrics in analyze(batch):
+            sample.record(path, violations)
+            yield path, violations, metrics
+        if precision is None or sample.precision_reached(precision):
+            break
+        rel = sample.overall()["relative_half_width"]
+        batch = sample.draw(sample.next_batch_size())
+        print(f"[ComplyC] Sample round {sample.rounds}: {sample.analyzed} file(s) so far"
+              + (f" (+-{rel:.1%})" if rel is not None else "")
+              + f", drawing {len(batch)} more")
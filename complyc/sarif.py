@@ -0,0 +1,126 @@
+"""
+sarif.py – Streaming SARIF 2.1.0 report writer (`--sarif-report`)
+
+For code-scanning ingestion. The rule metadata of the rules YAML (title,
+guidance, severity, reference) is written once, up front, in
+tool.driver.rules; every result then only carries its ruleId and ruleIndex
+into that table, the message and the location. The checks append the rule's
+guidance to their messages; since the guidance already is the rule's
+fullDescription, result messages leave it out. Results are written as files
+complete (one per line), so writing is linear and memory does not grow with
+the number of violations.
+
+Severities map to SARIF levels: critical -> error, major -> warning,
+minor -> note. Relative paths are written relative to %SRCROOT% (the
+directory ComplyC ran in), absolute ones as file: URIs.
+
+Like the JSON report, the file is built in <outfile>.partial and renamed
+when the run completes.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional
+from urllib.parse import quote
+
+SARIF_SCHEMA = "https://json.schemastore.org/sarif-2.1.0.json"
+SRCROOT = "%SRCROOT%"
+
+LEVELS = {"critical": "error", "major": "warning", "minor": "note"}
+
+
+def sarif_level(severity: Optional[str]) -> str:
+    return LEVELS.get((severity or "").lower(), "warning")
+
+
+def rule_descriptor(rule: Dict[str, Any]) -> Dict[str, Any]:
+    """tool.driver.rules entry of one rule from the YAML."""
+    descriptor: Dict[str, Any] = {"id": rule["id"]}
+    if rule.get("title"):
+        descriptor["shortDescription"] = {"text": rule["title"]}
+    if rule.get("guidance"):
+        descriptor["fullDescription"] = {"text": rule["guidance"]}
+    help_text = " ".join(str(rule[k]) for k in ("guidance", "reference") if rule.get(k))
+    if help_text:
+        descriptor["help"] = {"text": help_text}
+    descriptor["defaultConfiguration"] = {"level": sarif_level(rule.get("severity"))}
+    properties = {k: rule[k] for k in ("severity", "reference", "scope") if rule.get(k)}
+    if properties:
+        descriptor["properties"] = properties
+    return descriptor
+
+
+def artifact_location(path: str) -> Dict[str, str]:
+    if os.path.isabs(path):
+        return {"uri": Path(path).as_uri()}
+    return {"uri": quote(Path(os.path.normpath(path)).as_posix()), "uriBaseId": SRCROOT}
+
+
+class SarifReportFile:
+    def __init__(self, outfile: str, rules: List[Dict[str, Any]], style: Optional[Dict[str, Any]] = None):
+        self.outfile = outfile
+        self.partial = outfile + ".partial"
+        self.rule_index = {rule["id"]: i for i, rule in enumerate(rules)}
+        self.message_suffix = {rule["id"]: f" {rule['guidance']}" for rule in rules if rule.get("guidance")}
+        self.total_files = 0
+        self.total_results = 0
+        self._f = open(self.partial, "w", encoding="utf-8")
+
+        driver: Dict[str, Any] = {
+            "name": "ComplyC",
+            "rules": [rule_descriptor(rule) for rule in rules],
+        }
+        style = style or {}
+        rule_set = {k: style[k] for k in ("id", "name", "version") if style.get(k)}
+        if rule_set:
+            driver["properties"] = {"ruleSet": rule_set}
+        root = Path(os.getcwd()).as_uri().rstrip("/") + "/"
+        run_head = {
+            "tool": {"driver": driver},
+            "originalUriBaseIds": {SRCROOT: {"uri": root}},
+            "columnKind": "utf16CodeUnits",
+        }
+        head = json.dumps(run_head, indent=2)
+        # Leave the run object open: results are appended below
+        self._f.write(
+            '{\n  "$schema": ' + json.dumps(SARIF_SCHEMA) + ',\n  "version": "2.1.0",\n  "runs": [\n    '
+            + head[:-2].replace("\n", "\n    ") + ',\n      "results": ['
+        )
+
+    def _message(self, v) -> str:
+        """The violation message without the guidance suffix (see module docstring)."""
+        suffix = self.message_suffix.get(v.rule_id)
+        if suffix and v.message.endswith(suffix) and len(v.message) > len(suffix):
+            return v.message[:len(v.message) - len(suffix)]
+        return v.message
+
+    def add(self, path: str, violations: Iterable[Any]):
+        location = {"physicalLocation": {"artifactLocation": artifact_location(path)}}
+        for v in violations:
+            result: Dict[str, Any] = {"ruleId": v.rule_id}
+            index = self.rule_index.get(v.rule_id)
+            if index is not None:
+                result["ruleIndex"] = index
+            result["level"] = sarif_level(v.severity)
+            result["message"] = {"text": self._message(v)}
+            if v.line is not None:
+                loc = {"physicalLocation": {**location["physicalLocation"], "region": {"startLine": v.line}}}
+            else:
+                loc = location
+            result["locations"] = [loc]
+            self._f.write(",\n        " if self.total_results else "\n        ")
+            self._f.write(json.dumps(result, ensure_ascii=False))
+            self.total_results += 1
+        self.total_files += 1
+        self._f.flush()
+
+    def close(self):
+        self._f.write("\n      ]" if self.total_results else "]")
+        props = {"totalFiles": self.total_files, "totalResults": self.total_results}
+        self._f.write(',\n      "properties": ' + json.dumps(props) + "\n    }\n  ]\n}\n")
+        self._f.close()
+        os.replace(self.partial, self.outfile)
+        print(f"[ComplyC] SARIF report written to {self.outfile}")
@@ -0,0 +1,399 @@
+"""
+scheduler.py – Cost-aware work-stealing scheduler for ComplyC
+
+Files are ordered largest-expected-cost first (LPT) and pre-partitioned into
+one deque per worker. Each worker process drains its own deque; when it runs
+dry it steals the largest pending file from the most loaded peer, so a big
+generated file never starts last and becomes a straggler.
+
+Expected cost comes from per-file timings recorded on previous runs (scaled
+by the change in file size) and falls back to file size times the average
+seconds-per-byte observed so far.
+"""
+
+from __future__ import annotations
+
+import itertools
+import json
+import os
+import time
+from collections import deque
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Tuple
+
+
+# Rough parse+rules cost when no history exists yet (seconds per byte)
+DEFAULT_SECONDS_PER_BYTE = 3e-6
+
+# Tasks handed to a worker ahead of time, to hide the dispatch round trip.
+# Anything beyond this stays in the parent's deques and remains stealable.
+PREFETCH = 2
+
+# Paths pulled per batch from a streaming (discovery) input
+DISCOVERY_WINDOW = 256
+
+
+# ---------- timing history ----------
+
+class TimingStore:
+    """
+    Per-file analysis timings persisted between runs (JSON in the cache dir),
+    along with each file's mtime and violation count (for --priority).
+    """
+
+    FILENAME = "timings.json"
+
+    def __init__(self, cache_dir: Optional[str]):
+        self.path = os.path.join(cache_dir, self.FILENAME) if cache_dir else None
+        self.entries: Dict[str, Dict[str, float]] = {}
+        if self.path and os.path.isfile(self.path):
+            try:
+                with open(self.path, "r", encoding="utf-8") as f:
+                    self.entries = json.load(f)
+            except (OSError, ValueError):
+                self.entries = {}
+        self.seconds_per_byte = self._seconds_per_byte()
+
+    def _seconds_per_byte(self) -> float:
+        total_s = sum(e["seconds"] for e in self.entries.values())
+        total_b = sum(e["size"] for e in self.entries.values())
+        if total_s > 0 and total_b > 0:
+            return total_s / total_b
+        return DEFAULT_SECONDS_PER_BYTE
+
+    def estimate(self, path: str, size: Optional[int] = None) -> float:
+        """Expected analysis time for path, in seconds."""
+        if size is None:
+            try:
+                size = os.path.getsize(path)
+            except OSError:
+                size = 0
+        prev = self.entries.get(path)
+        if prev and prev.get("size"):
+            return prev["seconds"] * (size / prev["size"])
+        return size * self.seconds_per_byte
+
+    def density(self, path: str, size: Optional[int] = None) -> float:
+        """Violations per KiB on the previous run (0 if unknown)."""
+        prev = self.entries.get(path)
+        if not prev or prev.get("violations") is None:
+            return 0.0
+        if size is None:
+            size = prev.get("size", 0)
+        return prev["violations"] * 1024.0 / max(size, 1)
+
+    def changed_since_recorded(self, path: str, mtime: float, size: int) -> bool:
+        """True for files not analyzed before or modified since."""
+        prev = self.entries.get(path)
+        return not prev or prev.get("mtime") != mtime or prev.get("size") != size
+
+    def record(self, path: str, seconds: float, violations: Optional[int] = None):
+        try:
+            st = os.stat(path)
+        except OSError:
+            return
+        entry = {"size": st.st_size, "seconds": round(seconds, 6), "mtime": st.st_mtime}
+        if violations is None:
+            violations = self.entries.get(path, {}).get("violations")
+        if violations is not None:
+            entry["violations"] = violations
+        self.entries[path] = entry
+
+    def save(self):
+        if not self.path:
+            return
+        os.makedirs(os.path.dirname(self.path), exist_ok=True)
+        # Per-process temp name: per-file runs from ninja/make save concurrently
+        tmp = f"{self.path}.{os.getpid()}.tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(self.entries, f)
+        os.replace(tmp, self.path)
+
+
+# ---------- run statistics ----------
+
+class RunStats:
+    """Wall time, per-worker utilization and critical-path file of one run."""
+
+    def __init__(self):
+        self.jobs = 1
+        self.wall_seconds = 0.0
+        self.worker_busy: List[float] = []
+        self.file_seconds: Dict[str, float] = {}
+        self.steals = 0
+        self.critical_file: Optional[str] = None
+        self.critical_seconds = 0.0
+        self.pipeline = None  # pipeline.PipelineStats for --pipeline runs
+        self.jobserver_peak: Optional[int] = None  # Jobserver.peak_jobs of runs under make
+
+    def utilization(self) -> List[float]:
+        if self.wall_seconds <= 0:
+            return [0.0 for _ in self.worker_busy]
+        return [min(busy / self.wall_seconds, 1.0) for busy in self.worker_busy]
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            "jobs": self.jobs,
+            "wall_seconds": round(self.wall_seconds, 3),
+            "worker_utilization": [round(u, 3) for u in self.utilization()],
+            "steals": self.steals,
+            "critical_path_file": self.critical_file,
+            "critical_path_seconds": round(self.critical_seconds, 3),
+            **({"pipeline": self.pipeline.to_dict()} if self.pipeline else {}),
+            **({"jobserver_peak": self.jobserver_peak} if self.jobserver_peak is not None else {}),
+        }
+
+
+# ---------- worker process ----------
+
+def _worker_main(worker_id: int, rules, use_gcc: bool, want_metrics: bool, inbox, outbox):
+    """Worker loop: analyze (index, path) tasks until a None sentinel arrives."""
+    # Imported here so the module stays cheap to import in the parent
+    from .runner import analyze_file, metrics_to_tuple, violation_to_tuple
+
+    while True:
+        task = inbox.get()
+        if task is None:
+            return
+        index, path = task
+        t0 = time.perf_counter()
+        try:
+            metrics = [] if want_metrics else None
+            violations = analyze_file(path, rules, use_gcc, metrics)
+            payload = (
+                [violation_to_tuple(v) for v in violations],
+                [metrics_to_tuple(m) for m in metrics] if metrics is not None else None,
+            )
+            error = None
+        except Exception as e:
+            payload = None
+            try:
+                import pickle
+
+                pickle.dumps(e)
+                error = e
+            except Exception:
+                error = RuntimeError(f"{type(e).__name__}: {e}")
+        outbox.put((worker_id, index, payload, error, time.perf_counter() - t0))
+
+
+# ---------- parent side ----------
+
+def _distribute(batch: List[Tuple[int, float]], deques: List[deque], pending: List[float], in_order: bool = False):
+    """
+    LPT: hand out tasks largest first, each to the least loaded worker.
+    in_order keeps input order instead (the input is already by priority).
+    """
+    order = (lambda t: t[0]) if in_order else (lambda t: (-t[1], t[0]))
+    for index, cost in sorted(batch, key=order):
+        w = min(range(len(deques)), key=pending.__getitem__)
+        deques[w].append((index, cost))
+        pending[w] += cost
+    for d in deques:
+        # Keep every deque largest-first after merging a new batch
+        if len(d) > 1:
+            items = sorted(d, key=order)
+            d.clear()
+            d.extend(items)
+
+
+def run_scheduled(
+    paths: Iterable[str],
+    rules,
+    use_gcc: bool,
+    jobs: int,
+    want_metrics: bool,
+    timings: TimingStore,
+    stats: RunStats,
+    jobserver=None,
+    completion_order: bool = False,
+) -> Iterator[Tuple[int, str, Optional[tuple], Optional[BaseException]]]:
+    """
+    Analyze paths on `jobs` worker processes.
+
+    Yields (index, path, (violation_tuples, metric_tuples), error) strictly in
+    input order; out-of-order completions are buffered until their turn.
+    With completion_order, files are started in input order instead of
+    largest-first and every result is yielded as soon as it arrives.
+
+    A list is scheduled as a whole. Any other iterable (e.g. a discovery
+    stream) is consumed in windows: a small first batch so workers start
+    immediately, then DISCOVERY_WINDOW paths at a time, each batch ordered
+    largest-first.
+
+    With a make jobserver, worker 0 runs on this process's implicit slot and
+    any other worker is only started (and only gets files) once it holds a
+    token; the others' queued files are stolen by the running ones meanwhile.
+    """
+    # Only parallel runs pay for these imports (start-up time of -j 1 runs)
+    import multiprocessing
+    import queue
+
+    ctx = multiprocessing.get_context()
+    outbox = ctx.Queue()
+    inboxes = [ctx.Queue() for _ in range(jobs)]
+    # Started on first activation: under make a worker that never gets a
+    # token is never spawned
+    workers: List[Any] = [None] * jobs
+
+    if isinstance(paths, (list, tuple)):
+        first_window = window = max(len(paths), 1)
+    else:
+        first_window, window = jobs * PREFETCH, DISCOVERY_WINDOW
+    source = iter(paths)
+    path_of: Dict[int, str] = {}
+    deques = [deque() for _ in range(jobs)]
+    pending = [0.0] * jobs
+    inflight = [0] * jobs
+    stats.jobs = jobs
+    stats.worker_busy = [0.0] * jobs
+    intake_state = {"total": 0, "exhausted": False, "size": first_window}
+    tokens: List[Optional[bytes]] = [None] * jobs
+    active = [jobserver is None or w == 0 for w in range(jobs)]
+
+    def intake():
+        batch = []
+        for path in itertools.islice(source, intake_state["size"]):
+            index = intake_state["total"]
+            path_of[index] = path
+            batch.append((index, timings.estimate(path)))
+            intake_state["total"] += 1
+        if len(batch) < intake_state["size"]:
+            intake_state["exhausted"] = True
+        intake_state["size"] = window
+        _distribute(batch, deques, pending, completion_order)
+
+    def take(k: int) -> int:
+        index, cost = deques[k].popleft()
+        pending[k] -= cost
+        return index
+
+    def next_task(w: int) -> Optional[int]:
+        if deques[w]:
+            return take(w)
+        # Steal the largest pending file from the most loaded peer
+        victim = max(range(jobs), key=lambda k: (len(deques[k]) > 0, pending[k]))
+        if deques[victim]:
+            stats.steals += 1
+            return take(victim)
+        if not intake_state["exhausted"]:
+            intake()
+            if deques[w]:
+                return take(w)
+        return None
+
+    def spawn(w: int):
+        if workers[w] is None:
+            workers[w] = ctx.Process(
+                target=_worker_main,
+                args=(w, rules, use_gcc, want_metrics, inboxes[w], outbox),
+                daemon=True,
+            )
+            workers[w].start()
+
+    def feed(w: int):
+        if not active[w]:
+            return
+        while inflight[w] < PREFETCH:
+            index = next_task(w)
+            if index is None:
+                if inflight[w] == 0 and tokens[w] is not None:
+                    # Out of work: give the slot back to make right away
+                    jobserver.release(tokens[w])
+                    tokens[w] = None
+                    active[w] = False
+                return
+            inboxes[w].put((index, path_of[index]))
+            inflight[w] += 1
+
+    def grow():
+        """Activate idle workers for every jobserver token that is free."""
+        for w in range(jobs):
+            if active[w]:
+                continue
+            if intake_state["exhausted"] and not any(deques):
+                return
+            token = jobserver.try_acquire()
+            if token is None:
+                return
+            tokens[w], active[w] = token, True
+            spawn(w)
+            feed(w)
+
+    start = time.perf_counter()
+    paused = 0.0  # time the consumer spent between results (not the workers')
+    last_finish = -1.0
+    ready: Dict[int, tuple] = {}
+    next_index = 0
+    done = 0
+
+    try:
+        for w in range(jobs):
+            if active[w]:
+                spawn(w)
+                feed(w)
+        if jobserver is not None:
+            grow()
+
+        while done < intake_state["total"] or not intake_state["exhausted"]:
+            if not any(inflight):
+                for w in range(jobs):
+                    feed(w)
+                if not any(inflight):
+                    break
+            # Poll for tokens while some workers still wait for one
+            waiting = jobserver is not None and not all(active)
+            try:
+                w, index, payload, error, seconds = outbox.get(timeout=0.05 if waiting else 1.0)
+            except queue.Empty:
+                if waiting:
+                    grow()
+                dead = [p for p in workers if p is not None and not p.is_alive()]
+                if dead:
+                    raise RuntimeError(
+                        f"[ComplyC] worker process exited unexpectedly (exit code {dead[0].exitcode})"
+                    )
+                continue
+
+            done += 1
+            inflight[w] -= 1
+            path = path_of[index]
+            stats.worker_busy[w] += seconds
+            stats.file_seconds[path] = seconds
+            finish = time.perf_counter() - start
+            if finish >= last_finish:
+                last_finish = finish
+                stats.critical_file = path
+                stats.critical_seconds = seconds
+            feed(w)
+            if jobserver is not None:
+                grow()
+
+            if completion_order:
+                t0 = time.perf_counter()
+                yield index, path_of.pop(index), payload, error
+                paused += time.perf_counter() - t0
+                continue
+            ready[index] = (payload, error)
+            while next_index in ready:
+                payload, error = ready.pop(next_index)
+                t0 = time.perf_counter()
+                yield next_index, path_of.pop(next_index), payload, error
+                paused += time.perf_counter() - t0
+                next_index += 1
+
+        started = [(p, inboxes[w]) for w, p in enumerate(workers) if p is not None]
+        for _, inbox in started:
+            inbox.put(None)
+        for p, _ in started:
+            p.join()
+    finally:
+        stats.wall_seconds = time.perf_counter() - start - paused
+        if jobserver is not None:
+            stats.jobserver_peak = jobserver.peak_jobs
+        for w, token in enumerate(tokens):
+            if token is not None:
+                jobserver.release(token)
+                tokens[w] = None
+        for p in workers:
+            if p is not None and p.is_alive():
+                p.terminate()
@@ -0,0 +1,219 @@
+"""
+server.py – Long-lived ComplyC analysis daemon
+
+Listens on a Unix socket and speaks newline-delimited JSON-RPC 2.0. The
+process keeps everything that a CLI invocation would otherwise rebuild:
+the imported yaml/pycparser modules, the CParser instance, parsed rule files
+(re-read automatically when the YAML changes on disk) and an in-memory LRU of
+per-file results keyed by file (and header) mtimes.
+
+Methods:
+    run(argv, cwd)  – run `complyc.main` with argv in cwd; returns
+                      {"stdout", "stderr", "exit_code"}
+    ping()          – liveness check, returns {"pid", "uptime"}
+    stats()         – result-memo hit/miss counters
+    shutdown()      – stop the daemon
+
+Requests are executed one at a time (the CLI flow changes directory and
+captures stdout), connections are accepted concurrently. Because requests
+run on the connection threads, `-j` (forked worker processes) is rejected:
+forking a threaded process with redirected stdio is unsafe.
+
+Usage:
+    python -m complyc.server [--socket PATH] [--rules rules.yml]
+"""
+
+from __future__ import annotations
+
+import argparse
+import contextlib
+import io
+import json
+import os
+import socket
+import socketserver
+import sys
+import threading
+import time
+import traceback
+from typing import Any, Dict, Optional
+
+from .client import default_socket_path
+from .loader import load_rules
+from .main import main as cli_main
+from .runner import enable_result_memo
+
+
+# JSON-RPC 2.0 error codes
+PARSE_ERROR = -32700
+METHOD_NOT_FOUND = -32601
+INTERNAL_ERROR = -32603
+
+
+def _probe_run(argv) -> argparse.Namespace:
+    """The -j value and --watch flag of a run request (defaults if not parseable)."""
+    probe = argparse.ArgumentParser(add_help=False)
+    probe.add_argument("-j", "--jobs", type=int, default=1)
+    probe.add_argument("--watch", action="store_true")
+    try:
+        with contextlib.redirect_stderr(io.StringIO()):
+            args, _ = probe.parse_known_args(argv)
+    except SystemExit:
+        return argparse.Namespace(jobs=1, watch=False)  # let the CLI report the bad value
+    return args
+
+
+def _unsupported(argv) -> Optional[str]:
+    """Why the daemon refuses a run request, or None."""
+    args = _probe_run(argv)
+    if args.jobs != 1:
+        return ("-j is not supported by the daemon (it runs requests on threads); "
+                "run the CLI directly for parallel analysis")
+    if args.watch:
+        # A watch never returns: it would hold the service lock for good
+        return "--watch is not supported by the daemon; run the CLI directly to watch files"
+    return None
+
+
+class AnalysisService:
+    """The warm state shared by all connections."""
+
+    def __init__(self):
+        self.started = time.time()
+        self.memo = enable_result_memo()
+        self.lock = threading.Lock()
+        self.server = None
+
+    def run(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        argv = list(params.get("argv", []))
+        cwd = params.get("cwd") or os.getcwd()
+        refusal = _unsupported(argv)
+        if refusal:
+            return {"stdout": "", "stderr": f"[ComplyC] {refusal}\n", "exit_code": 2}
+        out, err = io.StringIO(), io.StringIO()
+        exit_code = 0
+        with self.lock:
+            old_cwd = os.getcwd()
+            try:
+                os.chdir(cwd)
+                with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+                    try:
+                        exit_code = cli_main(argv)
+                    except SystemExit as e:
+                        exit_code = e.code if isinstance(e.code, int) else (0 if e.code is None else 1)
+                    except Exception:
+                        traceback.print_exc()
+                        exit_code = 1
+            finally:
+                os.chdir(old_cwd)
+        return {"stdout": out.getvalue(), "stderr": err.getvalue(), "exit_code": exit_code}
+
+    def ping(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        return {"pid": os.getpid(), "uptime": round(time.time() - self.started, 1)}
+
+    def stats(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        return {
+            "memo_entries": len(self.memo.entries),
+            "memo_hits": self.memo.hits,
+            "memo_misses": self.memo.misses,
+        }
+
+    def shutdown(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        # server.shutdown() blocks until serve_forever() returns: do it elsewhere
+        threading.Thread(target=self.server.shutdown, daemon=True).start()
+        return {"stopping": True}
+
+
+METHODS = ("run", "ping", "stats", "shutdown")
+
+
+class RequestHandler(socketserver.StreamRequestHandler):
+    def handle(self):
+        service: AnalysisService = self.server.service
+        for line in self.rfile:
+            if not line.strip():
+                continue
+            try:
+                request = json.loads(line)
+            except ValueError:
+                self._reply(None, error=(PARSE_ERROR, "invalid JSON"))
+                continue
+            req_id = request.get("id")
+            method = request.get("method")
+            if method not in METHODS:
+                self._reply(req_id, error=(METHOD_NOT_FOUND, f"unknown method {method!r}"))
+                continue
+            try:
+                result = getattr(service, method)(request.get("params") or {})
+            except Exception as e:
+                self._reply(req_id, error=(INTERNAL_ERROR, str(e)))
+                continue
+            self._reply(req_id, result=result)
+
+    def _reply(self, req_id, result=None, error=None):
+        response: Dict[str, Any] = {"jsonrpc": "2.0", "id": req_id}
+        if error:
+            response["error"] = {"code": error[0], "message": error[1]}
+        else:
+            response["result"] = result
+        self.wfile.write(json.dumps(response).encode("utf-8") + b"\n")
+        self.wfile.flush()
+
+
+class DaemonServer(socketserver.ThreadingMixIn, socketserver.UnixStreamServer):
+    daemon_threads = True
+
+
+def _remove_stale_socket(path: str):
+    """Delete a leftover socket file, refusing if a daemon still answers on it."""
+    if not os.path.exists(path):
+        return
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as probe:
+        try:
+            probe.connect(path)
+        except OSError:
+            os.remove(path)
+            return
+    raise SystemExit(f"[ComplyC] A daemon is already listening on {path}")
+
+
+def serve(socket_path: str, preload_rules=None):
+    service = AnalysisService()
+    for rules_path in preload_rules or []:
+        load_rules(rules_path)
+        print(f"[ComplyC] Preloaded rules from {rules_path}")
+
+    _remove_stale_socket(socket_path)
+    old_umask = os.umask(0o077)
+    try:
+        server = DaemonServer(socket_path, RequestHandler)
+    finally:
+        os.umask(old_umask)
+    server.service = service
+    service.server = server
+    print(f"[ComplyC] Daemon listening on {socket_path} (pid {os.getpid()})", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+        with contextlib.suppress(OSError):
+            os.remove(socket_path)
+        print("[ComplyC] Daemon stopped")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ComplyC analysis daemon")
+    parser.add_argument("--socket", default=default_socket_path(), help="Unix socket path")
+    parser.add_argument(
+        "--rules",
+        action="append",
+        help="YAML rules file to load at start-up (repeatable; others load on first use)",
+    )
+    args = parser.parse_args()
+    serve(args.socket, args.rules)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
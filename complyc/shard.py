@@ -0,0 +1,73 @@
+"""
+shard.py – Deterministic file sharding for CI fan-out
+
+`--shard i/N` analyzes the i-th of N disjoint parts of the file list, so N
+machines can share one analysis. The partition only depends on the file
+list and the file sizes of the checkout:
+
+- files are ordered largest first, ties broken by a stable hash of the
+  normalized path (not Python's randomized hash()),
+- each file goes to the currently lightest shard (LPT), lowest index first.
+
+The local timing history is deliberately not used: it differs between
+machines (and runs), and every shard must compute the same partition. A
+digest of the whole partition is stored in each shard report so `complyc
+merge` can detect shards that disagreed.
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+from typing import List, Sequence, Tuple
+
+from .discovery import norm_path
+
+
+def parse_shard_spec(spec: str) -> Tuple[int, int]:
+    """'2/4' -> (2, 4); shard indices are 1-based like CI node indices."""
+    try:
+        index_s, count_s = spec.split("/", 1)
+        index, count = int(index_s), int(count_s)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"expected i/N (e.g. 2/4), got {spec!r}")
+    if count < 1 or not 1 <= index <= count:
+        raise argparse.ArgumentTypeError(f"shard index must be within 1..N, got {spec!r}")
+    return index, count
+
+
+def stable_hash(path: str) -> int:
+    import hashlib  # not at module level: main imports this module on every run
+
+    return int.from_bytes(hashlib.sha1(norm_path(path).encode("utf-8")).digest()[:8], "big")
+
+
+def _file_size(path: str) -> int:
+    try:
+        return os.path.getsize(path)
+    except OSError:
+        return 0
+
+
+def assign_shards(paths: Sequence[str], count: int) -> List[int]:
+    """Return the (0-based) shard of every path, balancing file size."""
+    import heapq
+
+    keys = [(-_file_size(p), stable_hash(p), norm_path(p), i) for i, p in enumerate(paths)]
+    shards = [0] * len(paths)
+    loads = [(0, s) for s in range(count)]
+    for neg_cost, _, _, i in sorted(keys):
+        load, s = heapq.heappop(loads)
+        shards[i] = s
+        heapq.heappush(loads, (load - neg_cost, s))
+    return shards
+
+
+def partition_digest(paths: Sequence[str], shards: Sequence[int]) -> str:
+    """Short fingerprint of the complete path -> shard mapping."""
+    import hashlib
+
+    h = hashlib.sha1()
+    for path, shard in sorted(zip(map(norm_path, paths), shards)):
+        h.update(f"{path}\t{shard}\n".encode("utf-8"))
+    return h.hexdigest()[:16]
@@ -0,0 +1,68 @@
+"""
+spill.py – Append-only on-disk store for per-file results
+
+Each finished file is written out as one JSON line ({"file", "violations"},
+the report's own file-entry layout) and flushed immediately, so a run keeps
+only running totals in memory, whatever the number of files. Reporters read
+the entries back as a stream.
+
+The spill is an anonymous temporary file: it disappears when closed or when
+the process exits, even after a crash.
+"""
+
+from __future__ import annotations
+
+import json
+import tempfile
+from dataclasses import asdict
+from typing import Any, Dict, Iterable, Iterator, Optional
+
+
+class ResultSpill:
+    def __init__(self, directory: Optional[str] = None):
+        self._f = tempfile.TemporaryFile("w+", encoding="utf-8", dir=directory)
+        self.total_files = 0
+        self.total_violations = 0
+        self.by_severity: Dict[str, int] = {}
+
+    def __len__(self) -> int:
+        return self.total_files
+
+    def __enter__(self) -> "ResultSpill":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def add(self, path: str, violations: Iterable[Any]):
+        """Append one file's results (Violation objects)."""
+        entry = {"file": path, "violations": [asdict(v) for v in violations]}
+        self._f.write(json.dumps(entry) + "\n")
+        self._f.flush()
+
+        self.total_files += 1
+        for v in entry["violations"]:
+            self.total_violations += 1
+            sev = v["severity"] or "unspecified"
+            self.by_severity[sev] = self.by_severity.get(sev, 0) + 1
+
+    def summary(self) -> Dict[str, Any]:
+        """Same layout as the report's "summary" block."""
+        return {
+            "total_files": self.total_files,
+            "total_violations": self.total_violations,
+            "by_severity": dict(self.by_severity),
+        }
+
+    def iter_entries(self) -> Iterator[Dict[str, Any]]:
+        """Stream the file entries back in the order they were added."""
+        self._f.flush()
+        self._f.seek(0)
+        try:
+            for line in self._f:
+                yield json.loads(line)
+        finally:
+            self._f.seek(0, 2)
+
+    def close(self):
+        self._f.close()
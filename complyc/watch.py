@@ -0,0 +1,344 @@
+"""
+watch.py – Watch mode for ComplyC
+
+`--watch <dirs>` analyzes the tree once, then waits for file changes (inotify
+on Linux, mtime polling elsewhere) and re-analyzes only the changed files and
+the files that include them. Parser, rules, include graph and per-file
+results all stay in memory, and each round prints only the violations that
+appeared or disappeared since the previous state. Changed paths and the
+watched directories follow the same excludes and .gitignore files as the
+initial scan, so ignored directories are neither walked nor watched.
+
+A directory moved out of (or within) the tree is reported as its path plus a
+trailing separator; the session then drops every result below it, as for a
+deleted file.
+"""
+
+from __future__ import annotations
+
+import ctypes
+import ctypes.util
+import fnmatch
+import os
+import select
+import struct
+import time
+from collections import Counter
+from typing import Any, Callable, Dict, Iterable, List, Optional, Sequence, Set, Tuple
+
+from .discovery import DEFAULT_INCLUDES, IgnoreChecker, iter_sources, norm_path
+from .includes import IncludeGraph
+from .rule_engine import Violation
+from .runner import analyze_file
+
+
+# Collect follow-up events for this long after the first one (editors often
+# write a file in several steps: truncate, write, rename, chmod ...)
+DEBOUNCE_SECONDS = 0.05
+
+POLL_INTERVAL = 0.5
+
+
+# ============================================================
+#   File-change sources
+# ============================================================
+
+# inotify constants from <sys/inotify.h>
+IN_CLOSE_WRITE = 0x00000008
+IN_MOVED_FROM = 0x00000040
+IN_MOVED_TO = 0x00000080
+IN_CREATE = 0x00000100
+IN_DELETE = 0x00000200
+IN_DELETE_SELF = 0x00000400
+IN_ISDIR = 0x40000000
+IN_NONBLOCK = 0o4000
+IN_CLOEXEC = 0o2000000
+
+WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_DELETE_SELF
+
+_EVENT_HEADER = struct.Struct("iIII")
+
+
+# skip_dir(path) -> True prunes an (excluded / .gitignored) directory
+SkipDir = Optional[Callable[[str], bool]]
+
+
+def _walk_dirs(roots: Iterable[str], skip_dir: SkipDir = None) -> Iterable[str]:
+    for root in roots:
+        for dirpath, dirnames, _ in os.walk(root):
+            dirnames[:] = sorted(
+                d for d in dirnames
+                if d != ".git" and not (skip_dir and skip_dir(os.path.join(dirpath, d)))
+            )
+            yield dirpath
+
+
+class InotifyWatcher:
+    """Recursive directory watcher on top of the raw inotify syscalls (ctypes)."""
+
+    def __init__(self, roots: Sequence[str], skip_dir: SkipDir = None):
+        libc_name = ctypes.util.find_library("c")
+        if not libc_name:
+            raise OSError("libc not found")
+        self._libc = ctypes.CDLL(libc_name, use_errno=True)
+        self.fd = self._libc.inotify_init1(IN_NONBLOCK | IN_CLOEXEC)
+        if self.fd < 0:
+            raise OSError(ctypes.get_errno(), "inotify_init1 failed")
+        self._dirs: Dict[int, str] = {}
+        self._skip_dir = skip_dir
+        for d in _walk_dirs(roots, skip_dir):
+            self._add(d)
+
+    def _add(self, directory: str):
+        wd = self._libc.inotify_add_watch(self.fd, os.fsencode(directory), WATCH_MASK)
+        if wd >= 0:
+            self._dirs[wd] = directory
+
+    def _remove_tree(self, directory: str):
+        """Stop watching directory and everything below it (it moved away)."""
+        prefix = directory + os.sep
+        for wd, d in list(self._dirs.items()):
+            if d == directory or d.startswith(prefix):
+                self._libc.inotify_rm_watch(self.fd, wd)
+                del self._dirs[wd]
+
+    def _read_events(self) -> Set[str]:
+        changed: Set[str] = set()
+        try:
+            data = os.read(self.fd, 64 * 1024)
+        except BlockingIOError:
+            return changed
+        offset = 0
+        while offset + _EVENT_HEADER.size <= len(data):
+            wd, mask, _cookie, length = _EVENT_HEADER.unpack_from(data, offset)
+            offset += _EVENT_HEADER.size
+            name = data[offset:offset + length].rstrip(b"\0").decode("utf-8", "surrogateescape")
+            offset += length
+            directory = self._dirs.get(wd)
+            if directory is None or not name:
+                continue
+            path = os.path.join(directory, name)
+            if mask & IN_ISDIR:
+                if mask & IN_MOVED_FROM:
+                    # Its watches would keep reporting under the old path
+                    self._remove_tree(path)
+                    changed.add(path + os.sep)
+                if mask & (IN_CREATE | IN_MOVED_TO) and not (self._skip_dir and self._skip_dir(path)):
+                    # New sub-tree: watch it and treat its files as changed
+                    for d in _walk_dirs([path], self._skip_dir):
+                        self._add(d)
+                        for entry in os.scandir(d):
+                            if entry.is_file():
+                                changed.add(entry.path)
+                continue
+            changed.add(path)
+        return changed
+
+    def wait(self) -> Set[str]:
+        """Block until something changes; return the changed paths."""
+        select.select([self.fd], [], [])
+        changed = self._read_events()
+        deadline = time.monotonic() + DEBOUNCE_SECONDS
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return changed
+            ready, _, _ = select.select([self.fd], [], [], remaining)
+            if ready:
+                changed |= self._read_events()
+
+    def close(self):
+        os.close(self.fd)
+
+
+class PollingWatcher:
+    """Portable fallback: compare (mtime, size) of all files every POLL_INTERVAL."""
+
+    def __init__(self, roots: Sequence[str], skip_dir: SkipDir = None):
+        self.roots = list(roots)
+        self._skip_dir = skip_dir
+        self._state = self._snapshot()
+
+    def _snapshot(self) -> Dict[str, Tuple[int, int]]:
+        state = {}
+        for d in _walk_dirs(self.roots, self._skip_dir):
+            try:
+                with os.scandir(d) as it:
+                    for entry in it:
+                        if entry.is_file():
+                            st = entry.stat()
+                            state[entry.path] = (st.st_mtime_ns, st.st_size)
+            except OSError:
+                continue
+        return state
+
+    def wait(self) -> Set[str]:
+        while True:
+            time.sleep(POLL_INTERVAL)
+            new = self._snapshot()
+            changed = {p for p in set(new) | set(self._state) if new.get(p) != self._state.get(p)}
+            self._state = new
+            if changed:
+                return changed
+
+    def close(self):
+        pass
+
+
+def make_watcher(roots: Sequence[str], skip_dir: SkipDir = None):
+    try:
+        return InotifyWatcher(roots, skip_dir)
+    except (OSError, AttributeError):
+        print("[ComplyC] inotify unavailable, falling back to polling")
+        return PollingWatcher(roots, skip_dir)
+
+
+# ============================================================
+#   Watch session (warm state + violation diffs)
+# ============================================================
+
+def _violation_key(v: Violation) -> Tuple[Any, ...]:
+    return (v.rule_id, v.line, v.message)
+
+
+def _format(prefix: str, path: str, v: Violation) -> str:
+    line = f"line {v.line}" if v.line is not None else "line ?"
+    return f"  {prefix} {path}: [{v.rule_id}] {line}: {v.message}"
+
+
+class WatchSession:
+    """In-memory per-file results for one watched tree."""
+
+    def __init__(
+        self,
+        roots: Sequence[str],
+        rules: List[Dict[str, Any]],
+        use_gcc: bool,
+        includes: Optional[Sequence[str]] = None,
+        excludes: Optional[Sequence[str]] = None,
+        use_gitignore: bool = True,
+    ):
+        self.roots = list(roots)
+        self.rules = rules
+        self.use_gcc = use_gcc
+        self.includes = list(includes) if includes else list(DEFAULT_INCLUDES)
+        self.excludes = list(excludes) if excludes else None
+        self.use_gitignore = use_gitignore
+        self.checkers = [IgnoreChecker(root, excludes, use_gitignore) for root in self.roots]
+        self.results: Dict[str, List[Violation]] = {}
+        self.graph = IncludeGraph(None)
+
+    def ignored(self, path: str, is_dir: bool = False) -> bool:
+        """Excluded or .gitignored below the watched root that contains path."""
+        for checker in self.checkers:
+            if not os.path.relpath(path, checker.root).startswith(os.pardir):
+                return checker.ignored(path, is_dir)
+        return False
+
+    def skip_dir(self, path: str) -> bool:
+        return self.ignored(path, True)
+
+    def _wanted(self, path: str) -> bool:
+        name = os.path.basename(path)
+        if not any(fnmatch.fnmatch(name, pat) for pat in self.includes):
+            return False
+        return not self.ignored(path)
+
+    def _analyze(self, key: str) -> Optional[List[Violation]]:
+        try:
+            return analyze_file(key, self.rules, self.use_gcc)
+        except Exception as e:
+            print(f"[ComplyC] {key}: analysis failed ({e}); keeping previous results")
+            return None
+
+    def initial_scan(self):
+        t0 = time.perf_counter()
+        for path in iter_sources(self.roots, self.includes, self.excludes, self.use_gitignore):
+            key = norm_path(path)
+            self.results[key] = self._analyze(key) or []
+        self.graph.build(self.results.keys())
+        total = sum(len(v) for v in self.results.values())
+        print(f"[ComplyC] Watching {len(self.results)} file(s): {total} violation(s) "
+              f"(initial scan {time.perf_counter() - t0:.2f}s)")
+
+    def apply_changes(self, changed_paths: Iterable[str]) -> int:
+        """Re-analyze changed files and their dependents; print the violation diff."""
+        t0 = time.perf_counter()
+        changed_paths = list(changed_paths)
+        newly_ignored: Set[str] = set()
+        if any(os.path.basename(p) == ".gitignore" for p in changed_paths):
+            # Re-read the ignore files; results of files now ignored are dropped
+            for checker in self.checkers:
+                checker.forget()
+            newly_ignored = {k for k in self.results if self.ignored(k)}
+        # Directories that moved away (see module docstring): drop their files
+        gone_dirs = [norm_path(p) + os.sep for p in changed_paths if p.endswith(os.sep)]
+        moved_away = {k for k in self.results if k.startswith(tuple(gone_dirs))} if gone_dirs else set()
+        changed = {norm_path(p) for p in changed_paths if self._wanted(p)} | newly_ignored | moved_away
+        if not changed:
+            return 0
+
+        added = removed = 0
+        deleted = {k for k in changed if k in newly_ignored or not os.path.isfile(k)}
+        for key in sorted(deleted):
+            for v in self.results.pop(key, []):
+                print(_format("-", key, v))
+                removed += 1
+        present = changed - deleted
+
+        # File set changed -> rebuild name resolution; otherwise just the edited files
+        if deleted or not present <= self.graph.known:
+            for key in present:
+                self.results.setdefault(key, [])
+            self.graph.build(self.results.keys())
+        else:
+            for key in present:
+                self.graph.update_file(key)
+
+        affected = present | (self.graph.dependents(changed) & set(self.results))
+        for key in sorted(affected):
+            new = self._analyze(key)
+            if new is None:
+                continue
+            old = self.results.get(key, [])
+            gone = Counter(map(_violation_key, old)) - Counter(map(_violation_key, new))
+            came = Counter(map(_violation_key, new)) - Counter(map(_violation_key, old))
+            for v in old:
+                k = _violation_key(v)
+                if gone[k] > 0:
+                    gone[k] -= 1
+                    print(_format("-", key, v))
+                    removed += 1
+            for v in new:
+                k = _violation_key(v)
+                if came[k] > 0:
+                    came[k] -= 1
+                    print(_format("+", key, v))
+                    added += 1
+            self.results[key] = new
+
+        total = sum(len(v) for v in self.results.values())
+        print(f"[ComplyC] {len(affected)} file(s) re-analyzed in {time.perf_counter() - t0:.2f}s: "
+              f"+{added} / -{removed} (total {total})", flush=True)
+        return len(affected)
+
+
+def run_watch(
+    roots: Sequence[str],
+    rules: List[Dict[str, Any]],
+    use_gcc: bool,
+    includes: Optional[Sequence[str]] = None,
+    excludes: Optional[Sequence[str]] = None,
+    use_gitignore: bool = True,
+):
+    """Initial scan, then re-analyze on every change until interrupted."""
+    session = WatchSession(roots, rules, use_gcc, includes, excludes, use_gitignore)
+    session.initial_scan()
+    watcher = make_watcher(roots, session.skip_dir)
+    try:
+        while True:
+            session.apply_changes(watcher.wait())
+    except KeyboardInterrupt:
+        print("\n[ComplyC] Watch stopped")
+    finally:
+        watcher.close()
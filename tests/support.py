@@ -0,0 +1,50 @@
+"""
+support.py – Shared helpers for the ComplyC tests
+
+Run the suite from the repository root:
+
+    python -m unittest discover tests        (or: python -m pytest tests)
+"""
+
+from __future__ import annotations
+
+import os
+import subprocess
+import sys
+import tempfile
+from typing import Dict, List
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+RULES = os.path.join(REPO_ROOT, "rules", "complyc_style.yml")
+EXAMPLES = os.path.join(REPO_ROOT, "examples")
+
+CLEAN_C = "int add(int a, int b)\n{\n    return a + b;\n}\n"
+BAD_C = "int BadName(void)\n{\n    return 42;\n}\n"
+
+
+def write_tree(root: str, files: Dict[str, str]) -> List[str]:
+    """Create files (relative path -> content) under root; return their paths."""
+    paths = []
+    for rel, text in files.items():
+        path = os.path.join(root, rel)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(text)
+        paths.append(path)
+    return paths
+
+
+def run_cli(args: List[str], cwd: str = REPO_ROOT, env: Dict[str, str] = None, **kwargs) -> subprocess.CompletedProcess:
+    """Run `python -m complyc.main ARGS` and capture its output."""
+    full_env = dict(os.environ, PYTHONPATH=REPO_ROOT, **(env or {}))
+    return subprocess.run(
+        [sys.executable, "-m", "complyc.main", *args],
+        cwd=cwd, env=full_env, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, **kwargs,
+    )
+
+
+def temp_dir(testcase) -> str:
+    """A temporary directory removed when the test ends."""
+    tmp = tempfile.TemporaryDirectory(prefix="complyc_test_")
+    testcase.addCleanup(tmp.cleanup)
+    return tmp.name
@@ -0,0 +1,90 @@
+import io
+import os
+import shutil
+import sys
+import threading
+import unittest
+from contextlib import redirect_stdout
+from unittest import mock
+
+from support import RULES, run_cli, temp_dir, write_tree
+
+from complyc import Analyzer
+from complyc.parser import PreprocessError
+from complyc.rule_engine import CHECK_HANDLERS
+
+SOURCE = '#include "local.h"\n\nint add_limit(int a)\n{\n    return a + LIMIT;\n}\n'
+
+
+@unittest.skipUnless(shutil.which("gcc"), "needs gcc")
+class AnalyzeSourceGccTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        write_tree(self.root, {"local.h": "#define LIMIT 4\n"})
+        self.analyzer = Analyzer(RULES, use_gcc=True)
+
+    def test_local_include_next_to_filename_resolves(self):
+        out = io.StringIO()
+        with redirect_stdout(out):
+            violations = list(self.analyzer.analyze_source(SOURCE, os.path.join(self.root, "mod.c")))
+        self.assertTrue(all(v.file.endswith("mod.c") for v in violations))
+        self.assertEqual(out.getvalue(), "")
+
+    def test_preprocess_failure_raises_silently(self):
+        out = io.StringIO()
+        with redirect_stdout(out), self.assertRaises(PreprocessError) as ctx:
+            list(self.analyzer.analyze_source(SOURCE, os.path.join(self.root, "sub", "mod.c")))
+        self.assertIn("local.h", str(ctx.exception))
+        self.assertEqual(out.getvalue(), "")
+
+
+class AnalyzeFilesQuietTest(unittest.TestCase):
+    def test_nothing_is_printed(self):
+        root = temp_dir(self)
+        write_tree(root, {"a.c": "int BadName(void)\n{\n    return 42;\n}\n"})
+        out = io.StringIO()
+        with redirect_stdout(out):
+            violations = list(Analyzer(RULES, use_gcc=False).analyze_files([root]))
+        self.assertTrue(violations)
+        self.assertEqual(out.getvalue(), "")
+
+
+BROKEN_RULE = {"id": "BROKEN_001", "scope": "function", "check": "regex", "pattern": "("}
+BAD_SOURCE = "int BadName(void)\n{\n    return 42;\n}\n"
+
+
+class WarningsTest(unittest.TestCase):
+    def test_failing_rule_is_logged_not_printed(self):
+        out = io.StringIO()
+        with redirect_stdout(out), self.assertLogs("complyc", "WARNING") as logs:
+            list(Analyzer([BROKEN_RULE], use_gcc=False).analyze_source(BAD_SOURCE, "a.c"))
+        self.assertEqual(out.getvalue(), "")
+        self.assertIn("Error in rule BROKEN_001", logs.output[0])
+
+    def test_cli_prints_failing_rule(self):
+        root = temp_dir(self)
+        rules, source = write_tree(root, {
+            "rules.yml": 'rules:\n  - id: BROKEN_001\n    scope: function\n    check: regex\n    pattern: "("\n',
+            "a.c": BAD_SOURCE,
+        })
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", rules, source], cwd=root)
+        self.assertIn("[ComplyC] Error in rule BROKEN_001", result.stdout)
+
+    def test_other_threads_keep_their_output(self):
+        # The API must not swap the process-wide sys.stdout while it runs
+        out = io.StringIO()
+
+        def check(node, rule, ctx):
+            t = threading.Thread(target=lambda: sys.stdout.write("from another thread\n"))
+            t.start()
+            t.join()
+            return []
+
+        with redirect_stdout(out), mock.patch.dict(CHECK_HANDLERS, {"thread_probe": check}):
+            list(Analyzer([{"id": "P", "scope": "function", "check": "thread_probe"}],
+                          use_gcc=False).analyze_source(BAD_SOURCE, "a.c"))
+        self.assertEqual(out.getvalue(), "from another thread\n")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,70 @@
+import os
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, temp_dir, write_tree
+
+from complyc.checkpoint import Journal, iter_checkpointed
+from complyc.loader import load_rules
+from complyc.runner import iter_analyze
+
+
+class CheckpointResumeTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        self.paths = write_tree(self.root, {f"f{i}.c": (BAD_C if i % 2 else CLEAN_C) for i in range(4)})
+        self.journal_path = os.path.join(self.root, "cache", "checkpoint.ndjson")
+        _, self.rules = load_rules(RULES)
+        self.analyzed = []
+
+    def analyze(self, paths):
+        self.analyzed.extend(os.path.basename(p) for p in paths)
+        return iter_analyze(paths, self.rules, False)
+
+    def checkpointed(self, resume):
+        journal = Journal(self.journal_path, self.rules, False, False)
+        return journal, iter_checkpointed(self.paths, journal, resume, self.analyze)
+
+    def interrupted_run(self, files_done):
+        journal, results = self.checkpointed(resume=False)
+        for _ in range(files_done):
+            next(results)
+        journal.close()  # the process dies here
+
+    def test_resume_skips_journaled_files_and_keeps_order(self):
+        journal, full = self.checkpointed(resume=False)
+        expected = [(p, v) for p, v, _ in full]
+        journal.finish()
+
+        self.interrupted_run(files_done=2)
+        self.analyzed.clear()
+        journal, results = self.checkpointed(resume=True)
+        resumed = [(p, v) for p, v, _ in results]
+        journal.finish()
+
+        self.assertEqual(self.analyzed, ["f2.c", "f3.c"])
+        self.assertEqual(resumed, expected)
+        self.assertFalse(os.path.exists(self.journal_path))
+
+    def test_changed_file_is_analyzed_again(self):
+        self.interrupted_run(files_done=2)
+        with open(self.paths[0], "a") as f:
+            f.write("/* edited */\n")
+        self.analyzed.clear()
+        journal, results = self.checkpointed(resume=True)
+        list(results)
+        journal.finish()
+        self.assertEqual(self.analyzed, ["f0.c", "f2.c", "f3.c"])
+
+    def test_truncated_last_line_is_ignored(self):
+        self.interrupted_run(files_done=2)
+        with open(self.journal_path, "a") as f:
+            f.write('{"key": "f2.c", "sig"')
+        self.analyzed.clear()
+        journal, results = self.checkpointed(resume=True)
+        self.assertEqual(len(list(results)), 4)
+        journal.finish()
+        self.assertEqual(self.analyzed, ["f2.c", "f3.c"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,70 @@
+import gzip
+import json
+import os
+import unittest
+from unittest import mock
+
+from support import BAD_C, CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+from complyc.compact import convert_to_v1
+
+# A file whose violations are not the last rows, between clean files
+MIXED_C = "int g_count;\nint Another(void)\n{\n    return g_count;\n}\n"
+
+
+class CompactReportTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        self.sources = write_tree(self.root, {"a.c": CLEAN_C, "b.c": BAD_C, "c.c": MIXED_C, "d.c": CLEAN_C})
+
+    def report(self, name, *extra):
+        out = os.path.join(self.root, name)
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--json-report", out, *extra, *self.sources],
+                         cwd=self.root)
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        return out
+
+    def read(self, path):
+        with open(path, "rb") as f:
+            return f.read()
+
+    def test_v2_round_trip_matches_the_v1_report(self):
+        v1 = self.report("v1.json")
+        v2 = self.report("v2.json.gz", "--json-schema", "2")
+        with gzip.open(v2, "rt", encoding="utf-8") as f:
+            self.assertEqual(json.load(f)["version"], 2)
+        back = os.path.join(self.root, "back.json")
+        # Streamed: the report is never loaded as a whole
+        with mock.patch("json.load", side_effect=AssertionError("json.load")):
+            convert_to_v1(v2, back)
+        self.assertEqual(self.read(back), self.read(v1))
+
+        # v1 -> v1 re-writes it unchanged (here: through gzip and back)
+        packed, unpacked = os.path.join(self.root, "v1.json.gz"), os.path.join(self.root, "unpacked.json")
+        convert_to_v1(v1, packed)
+        convert_to_v1(packed, unpacked)
+        self.assertEqual(self.read(unpacked), self.read(v1))
+
+    def test_convert_cli(self):
+        v2 = self.report("v2.json", "--json-schema", "2")
+        result = run_cli(["convert", v2, "-o", os.path.join(self.root, "out.json")], cwd=self.root)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        with open(os.path.join(self.root, "out.json"), encoding="utf-8") as f:
+            self.assertEqual(len(json.load(f)["files"]), 4)
+
+    def test_not_a_report(self):
+        bogus = os.path.join(self.root, "bogus.json")
+        with open(bogus, "w", encoding="utf-8") as f:
+            json.dump({"summary": {}}, f)
+        with self.assertRaises(ValueError):
+            convert_to_v1(bogus, os.path.join(self.root, "out.json"))
+
+    def test_schema_2_needs_a_json_report(self):
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--json-schema", "2", *self.sources],
+                         cwd=self.root)
+        self.assertEqual(result.returncode, 2)
+        self.assertIn("--json-schema 2 needs a JSON report", result.stderr)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,65 @@
+import os
+import unittest
+
+from support import CLEAN_C, temp_dir, write_tree
+
+from complyc.discovery import iter_sources, select_paths
+
+TREE = {
+    "a.c": CLEAN_C,
+    "b.h": CLEAN_C,
+    "notes.txt": "",
+    "src/c.c": CLEAN_C,
+    "src/deep/d.c": CLEAN_C,
+    "build/gen.c": CLEAN_C,
+    ".gitignore": "build/\n",
+}
+
+
+class IterSourcesTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        write_tree(self.root, TREE)
+        cwd = os.getcwd()
+        os.chdir(self.root)
+        self.addCleanup(os.chdir, cwd)
+
+    def sources(self, *specs, **kwargs):
+        return [p.replace(os.sep, "/") for p in iter_sources(specs, **kwargs)]
+
+    def test_directory_walk_applies_includes_and_gitignore(self):
+        self.assertEqual(self.sources("."), ["a.c", "b.h", "src/c.c", "src/deep/d.c"])
+        self.assertEqual(self.sources(".", use_gitignore=False),
+                         ["a.c", "b.h", "build/gen.c", "src/c.c", "src/deep/d.c"])
+        self.assertEqual(self.sources("src", excludes=["deep/"]), ["src/c.c"])
+
+    def test_globs(self):
+        self.assertEqual(self.sources("*.c"), ["a.c"])
+        self.assertEqual(self.sources("src/**/*.c"), ["src/c.c", "src/deep/d.c"])
+        self.assertEqual(self.sources("**/*.c"), ["a.c", "src/c.c", "src/deep/d.c"])
+
+    def test_globs_rooted_at_dot(self):
+        self.assertEqual(self.sources("./*.c"), ["a.c"])
+        self.assertEqual(self.sources("./**/*.c"), ["a.c", "src/c.c", "src/deep/d.c"])
+        self.assertEqual(self.sources("./src/*.c"), ["./src/c.c"])
+
+    def test_explicit_files_and_duplicates(self):
+        self.assertEqual(self.sources("notes.txt", "missing.c", "a.c", "*.c", "./a.c"),
+                         ["notes.txt", "missing.c", "a.c"])
+
+
+class SelectPathsTest(unittest.TestCase):
+    KNOWN = ["a.c", "b.h", os.path.join("src", "c.c"), os.path.join("src", "deep", "d.c")]
+
+    def select(self, *specs):
+        return [p.replace(os.sep, "/") for p in select_paths(self.KNOWN, specs)]
+
+    def test_same_selection_as_the_file_system(self):
+        self.assertEqual(self.select("src"), ["src/c.c", "src/deep/d.c"])
+        self.assertEqual(self.select("*.c"), ["a.c"])
+        self.assertEqual(self.select("./*.c"), ["a.c"])
+        self.assertEqual(self.select("./**/*.c"), ["a.c", "src/c.c", "src/deep/d.c"])
+
+
+if __name__ == "__main__":
+    unittest.main()
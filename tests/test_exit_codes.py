@@ -0,0 +1,29 @@
+import unittest
+
+from support import CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+
+class ExitCodeTest(unittest.TestCase):
+    def test_history_error_reaches_the_process(self):
+        # Not a git repository: history cannot list commits and returns 2
+        root = temp_dir(self)
+        result = run_cli(["history", "--rules", RULES, "--no-gcc", "--range", "HEAD"], cwd=root,
+                         env={"GIT_CEILING_DIRECTORIES": root})
+        self.assertEqual(result.returncode, 2, result.stdout + result.stderr)
+
+    def test_subcommands_return_zero_on_success(self):
+        root = temp_dir(self)
+        write_tree(root, {"a.c": CLEAN_C})
+        analyze = run_cli(["--no-gcc", "--rules", RULES, "--json-report", "r.json", "a.c"], cwd=root)
+        self.assertEqual(analyze.returncode, 0, analyze.stderr)
+        for args in (["merge", "--ordered", "-o", "m.json", "r.json"], ["convert", "r.json", "-o", "c.json"]):
+            result = run_cli(args, cwd=root)
+            self.assertEqual(result.returncode, 0, result.stderr)
+
+    def test_convert_error_is_nonzero(self):
+        result = run_cli(["convert", "missing.json", "-o", "out.json"], cwd=temp_dir(self))
+        self.assertEqual(result.returncode, 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
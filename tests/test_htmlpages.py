@@ -0,0 +1,68 @@
+import json
+import os
+import unittest
+
+from support import temp_dir
+
+from complyc.htmlpages import PagedHtmlReport
+from complyc.rule_engine import Violation
+
+RULES = [
+    {"id": "files", "title": "A rule named like the file table", "severity": "minor"},
+    {"id": "a/b", "severity": "major"},
+    {"id": "a_b", "severity": "major"},
+]
+
+
+def generate(directory, violations_per_file):
+    site = PagedHtmlReport(directory, RULES)
+    for path, rule_ids in violations_per_file.items():
+        site.add(path, [Violation(rule_id, f"{rule_id} here", path, line=1, severity="minor") for rule_id in rule_ids])
+    site.close()
+    return site
+
+
+def chunk_data(directory, rel):
+    with open(os.path.join(directory, rel), encoding="utf-8") as f:
+        text = f.read()
+    return json.loads(text[text.index(",") + 1:text.rindex(")")])
+
+
+class PagedHtmlReportTest(unittest.TestCase):
+    def setUp(self):
+        self.dir = temp_dir(self)
+
+    def test_rule_chunks_do_not_collide_with_the_file_table(self):
+        site = generate(self.dir, {"x.c": ["files"], "y.c": []})
+        self.assertEqual(site.by_rule["files"].chunks, [["data/rule-files-0001.js", 1]])
+        self.assertEqual(site.file_rows.chunks, [["data/files-0001.js", 2]])
+        self.assertEqual([row[0] for row in chunk_data(self.dir, "data/files-0001.js")["rows"]], ["x.c", "y.c"])
+        self.assertEqual(chunk_data(self.dir, "data/rule-files-0001.js")["files"], ["x.c"])
+
+    def test_rules_with_the_same_slug_get_their_own_pages(self):
+        site = generate(self.dir, {"x.c": ["a/b", "a_b"]})
+        pages = {site.slug("a/b"), site.slug("a_b")}
+        self.assertEqual(len(pages), 2)
+        for slug in pages:
+            self.assertTrue(os.path.isfile(os.path.join(self.dir, "rules", f"{slug}.html")))
+            self.assertTrue(os.path.isfile(os.path.join(self.dir, "data", f"rule-{slug}-0001.js")))
+
+    def test_pages_are_replaced_not_rewritten_in_place(self):
+        generate(self.dir, {"x.c": ["files"]})
+        index = os.path.join(self.dir, "index.html")
+        old = os.path.join(self.dir, "old-index.html")
+        os.link(index, old)
+        with open(old, encoding="utf-8") as f:
+            before = f.read()
+        generate(self.dir, {"x.c": ["files", "files"]})
+        # A new file was renamed over index.html; the old one is untouched
+        with open(old, encoding="utf-8") as f:
+            self.assertEqual(f.read(), before)
+        with open(index, encoding="utf-8") as f:
+            self.assertNotEqual(f.read(), before)
+        leftovers = [name for _, _, names in os.walk(self.dir) for name in names if name.endswith(".tmp")]
+        self.assertEqual(leftovers, [])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,45 @@
+import os
+import subprocess
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+
+def git(cwd, *args):
+    subprocess.run(["git", *args], cwd=cwd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+class ChangedSinceTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        write_tree(self.root, {
+            "include/config.h": "#define LIMIT 4\n",
+            "src/user.c": '#include "config.h"\n' + BAD_C,
+            "src/other.c": CLEAN_C,
+        })
+        git(self.root, "init", "-q")
+        git(self.root, "add", ".")
+        git(self.root, "-c", "user.name=t", "-c", "user.email=t@example.com", "commit", "-qm", "init")
+
+    def changed_since(self):
+        result = run_cli(
+            ["--no-gcc", "--no-reports", "--rules", RULES, "--changed-since", "HEAD", "src/user.c", "src/other.c"],
+            cwd=self.root,
+        )
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        return result.stdout
+
+    def test_changed_header_reanalyzes_includer(self):
+        first = self.changed_since()
+        self.assertIn("analyzing 2, 0 from cache", first)
+        self.assertIn("analyzing 0, 2 from cache", self.changed_since())
+
+        # The header is not among the analyzed files, only its includer is
+        with open(os.path.join(self.root, "include", "config.h"), "a") as f:
+            f.write("#define OTHER 1\n")
+        out = self.changed_since()
+        self.assertIn("0 file(s), 1 dependent(s); analyzing 1, 1 from cache", out)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,38 @@
+import os
+import unittest
+
+from support import CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+from complyc.loader import load_rules
+
+
+class RuleBundleTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        self.source = write_tree(self.root, {"a.c": CLEAN_C})[0]
+
+    def run_complyc(self, *extra):
+        result = run_cli(["--no-gcc", "--no-reports", "--quiet", "--rules", RULES, *extra, self.source],
+                         cwd=self.root)
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+
+    def test_plain_run_writes_no_cache(self):
+        self.run_complyc()
+        self.assertEqual(sorted(os.listdir(self.root)), ["a.c"])
+
+    def test_explicit_cache_dir_keeps_the_bundle(self):
+        cache = os.path.join(self.root, "cache")
+        self.run_complyc("--cache-dir", cache)
+        bundles = os.listdir(os.path.join(cache, "rules"))
+        self.assertEqual(len(bundles), 1)
+        self.assertTrue(bundles[0].endswith(".bundle"))
+
+    def test_bundle_loads_the_same_rules(self):
+        cache = os.path.join(self.root, "cache")
+        parsed = load_rules(RULES)
+        self.assertEqual(load_rules(RULES, cache_dir=cache), parsed)  # writes the bundle
+        self.assertEqual(load_rules(RULES, cache_dir=cache), parsed)  # reads it
+
+
+if __name__ == "__main__":
+    unittest.main()
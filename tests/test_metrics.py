@@ -0,0 +1,31 @@
+import unittest
+
+from complyc.metrics import compute_function_metrics
+from complyc.parser import parse_c_source
+
+
+def metrics_of(src: str):
+    return compute_function_metrics(parse_c_source(src).ext[-1], "t.c")
+
+
+class StatementCountTest(unittest.TestCase):
+    def test_braceless_bodies_are_counted(self):
+        braced = metrics_of("void f(int x) { if (x) { x = 1; } else { x = 2; } while (x) { x--; } }")
+        braceless = metrics_of("void f(int x) { if (x) x = 1; else x = 2; while (x) x--; }")
+        self.assertEqual(braceless.statements, 5)
+        self.assertEqual(braced.statements, braceless.statements)
+
+    def test_case_label_and_do_bodies(self):
+        m = metrics_of(
+            "int f(int x) { switch (x) { case 1: x = 3; break; default: x = 4; }"
+            " do x--; while (x); lbl: return x; }"
+        )
+        # switch, do, label | case, default | x=3, break, x=4 | x-- | return
+        self.assertEqual(m.statements, 10)
+
+    def test_blocks_are_not_statements(self):
+        self.assertEqual(metrics_of("void f(void) { { ; } }").statements, 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,53 @@
+import json
+import os
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+# Slow enough to finish after the small files in a -j 2 run
+BIG_C = "".join(f"int add{i}(int a, int b)\n{{\n    return a + b;\n}}\n" for i in range(1500))
+
+
+class NdjsonStreamTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+
+    def run_ndjson(self, sources, *extra):
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--cache-dir", os.path.join(self.root, "cache"),
+                          "--format", "ndjson", *extra, *sources], cwd=self.root)
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        return [json.loads(line) for line in result.stdout.splitlines()]
+
+    def test_record_shape(self):
+        clean, bad = write_tree(self.root, {"clean.c": CLEAN_C, "bad.c": BAD_C})
+        records = self.run_ndjson([clean, bad])
+        self.assertEqual(records[0]["type"], "start")
+        self.assertEqual(records[0]["version"], 1)
+        self.assertEqual(records[-1]["type"], "summary")
+        self.assertEqual(records[-1]["total_files"], 2)
+
+        files = [r for r in records if r["type"] == "file"]
+        self.assertEqual(sorted(os.path.basename(r["file"]) for r in files), ["bad.c", "clean.c"])
+        violations = [r for r in records if r["type"] == "violation"]
+        self.assertTrue(violations)
+        self.assertEqual(len(violations), records[-1]["total_violations"])
+        for v in violations:
+            self.assertTrue({"file", "line", "rule_id", "severity", "message"} <= set(v))
+        # Each "file" record counts, and follows, that file's violations
+        for i, done in enumerate(records):
+            if done["type"] == "file":
+                own = [r for r in violations if r["file"] == done["file"]]
+                self.assertEqual(done["violations"], len(own))
+                self.assertTrue(all(records.index(v) < i for v in own))
+
+    def test_reports_keep_input_order(self):
+        sources = write_tree(self.root, {"a.c": BIG_C, "b.c": BAD_C, "c.c": CLEAN_C, "d.c": BAD_C})
+        report = os.path.join(self.root, "report.json")
+        self.run_ndjson(sources, "-j", "2", "--json-report", report)
+        with open(report, encoding="utf-8") as f:
+            files = [entry["file"] for entry in json.load(f)["files"]]
+        self.assertEqual([os.path.basename(p) for p in files], ["a.c", "b.c", "c.c", "d.c"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,62 @@
+import os
+import threading
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, temp_dir, write_tree
+
+from complyc.loader import load_rules
+from complyc.pipeline import iter_pipeline
+
+
+def consume(results, timeout=30):
+    """Drain results on a thread; return (paths yielded, exception raised)."""
+    seen, raised = [], []
+
+    def run():
+        try:
+            for path, _, _ in results:
+                seen.append(os.path.basename(path))
+        except Exception as e:
+            raised.append(e)
+
+    t = threading.Thread(target=run, daemon=True)
+    t.start()
+    t.join(timeout)
+    if t.is_alive():
+        raise AssertionError("pipeline did not finish (hang)")
+    return seen, raised[0] if raised else None
+
+
+class PipelineErrorTest(unittest.TestCase):
+    def setUp(self):
+        self.a, self.b = write_tree(temp_dir(self), {"a.c": CLEAN_C, "b.c": BAD_C})
+        _, self.rules = load_rules(RULES)
+
+    def pipeline(self, paths, **kwargs):
+        return iter_pipeline(paths, self.rules, False, queue_size=1, preprocess_threads=2, **kwargs)
+
+    def test_results_in_input_order(self):
+        seen, error = consume(self.pipeline([self.a, self.b, self.a]))
+        self.assertIsNone(error)
+        self.assertEqual(seen, ["a.c", "b.c", "a.c"])
+
+    def test_file_error_surfaces_at_its_turn(self):
+        missing = self.a + ".missing"
+        seen, error = consume(self.pipeline([self.a, missing, self.b]))
+        self.assertEqual(seen, ["a.c"])
+        self.assertIsInstance(error, FileNotFoundError)
+
+    def test_failing_input_stream_does_not_hang(self):
+        def sources():
+            yield self.a
+            yield self.b
+            raise OSError("discovery failed")
+
+        seen, error = consume(self.pipeline(sources()))
+        self.assertEqual(seen, ["a.c", "b.c"])
+        self.assertIsInstance(error, OSError)
+        self.assertEqual(str(error), "discovery failed")
+
+
+if __name__ == "__main__":
+    unittest.main()
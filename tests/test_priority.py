@@ -0,0 +1,43 @@
+import json
+import os
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+from complyc.runner import InputOrder
+
+
+class InputOrderTest(unittest.TestCase):
+    def test_results_come_back_in_input_order(self):
+        order = InputOrder()
+        self.assertEqual(list(order.track(["a", "b", "c"])), ["a", "b", "c"])
+        self.assertEqual(order.add("c", 3), [])
+        self.assertEqual(order.add("a", 1), [("a", 1)])
+        self.assertEqual(order.add("b", 2), [("b", 2), ("c", 3)])
+
+    def test_duplicate_paths_keep_their_positions(self):
+        order = InputOrder()
+        list(order.track(["a", "b", "a"]))
+        self.assertEqual(order.add("b", 2), [])
+        self.assertEqual(order.add("a", 1), [("a", 1), ("b", 2)])
+        self.assertEqual(order.add("a", 3), [("a", 3)])
+
+
+class PriorityReportOrderTest(unittest.TestCase):
+    def test_reports_keep_input_order(self):
+        root = temp_dir(self)
+        sources = write_tree(root, {"a.c": BAD_C, "b.c": CLEAN_C, "c.c": BAD_C, "d.c": CLEAN_C})
+        # Newest first: --priority analyzes d, c, b, a
+        for age, path in enumerate(reversed(sources)):
+            os.utime(path, (1_000_000 - age * 100, 1_000_000 - age * 100))
+        report = os.path.join(root, "report.json")
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--cache-dir", os.path.join(root, "cache"),
+                          "--priority", "-j", "2", "--json-report", report, *sources], cwd=root)
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        with open(report, encoding="utf-8") as f:
+            files = [entry["file"] for entry in json.load(f)["files"]]
+        self.assertEqual([os.path.basename(p) for p in files], ["a.c", "b.c", "c.c", "d.c"])
+
+
+if __name__ == "__main__":
+    unittest.main()
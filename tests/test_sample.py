@@ -0,0 +1,48 @@
+import unittest
+from contextlib import redirect_stdout
+from io import StringIO
+from types import SimpleNamespace
+
+from support import CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+from complyc.sample import MIN_PER_STRATUM, StratifiedSample, _allocate, iter_sample
+
+
+def constant_results(paths):
+    """Every file has exactly three violations: zero variance everywhere."""
+    for p in paths:
+        yield p, [SimpleNamespace(rule_id="R1")] * 3, None
+
+
+class SampleSizeTest(unittest.TestCase):
+    def test_floor_never_exceeds_the_budget(self):
+        self.assertEqual(_allocate(1, [5.0], [10], floor=2), [1])
+        self.assertEqual(sum(_allocate(3, [1.0, 1.0], [10, 10], floor=2)), 3)
+        self.assertEqual(_allocate(5, [0.0, 1.0], [10, 10], floor=[4, 0]), [4, 1])
+
+    def test_sample_of_one_analyzes_one_file(self):
+        root = temp_dir(self)
+        write_tree(root, {f"f{i}.c": CLEAN_C for i in range(6)})
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--sample", "1", "--sample-seed", "1", "."],
+                         cwd=root)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("Total files analyzed   : 1", result.stdout)
+
+
+class SamplePrecisionTest(unittest.TestCase):
+    def setUp(self):
+        self.paths = write_tree(temp_dir(self), {f"{d}/f{i}.c": CLEAN_C for d in "ab" for i in range(20)})
+
+    def test_zero_variance_pilot_does_not_stop_sampling(self):
+        sample = StratifiedSample(self.paths, ["R1"], 4, seed=7)
+        with redirect_stdout(StringIO()):
+            analyzed = list(iter_sample(sample, constant_results, precision=0.1))
+        self.assertGreater(sample.rounds, 1)
+        for s in sample.strata:
+            self.assertGreaterEqual(len(s.observed), min(MIN_PER_STRATUM, s.size))
+        self.assertEqual(len(analyzed), sample.analyzed)
+        self.assertAlmostEqual(sample.overall()["total"], 3 * len(self.paths))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,48 @@
+import json
+import os
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+
+class SarifReportTest(unittest.TestCase):
+    def setUp(self):
+        root = temp_dir(self)
+        sources = write_tree(root, {"src/clean.c": CLEAN_C, "src/bad.c": BAD_C})
+        out = os.path.join(root, "report.sarif")
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--sarif-report", out,
+                          os.path.relpath(sources[0], root), os.path.relpath(sources[1], root)], cwd=root)
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        self.assertFalse(os.path.exists(out + ".partial"))
+        with open(out, encoding="utf-8") as f:
+            self.sarif = json.load(f)
+        self.run = self.sarif["runs"][0]
+
+    def test_shape(self):
+        self.assertEqual(self.sarif["version"], "2.1.0")
+        self.assertEqual(len(self.sarif["runs"]), 1)
+        driver = self.run["tool"]["driver"]
+        self.assertEqual(driver["name"], "ComplyC")
+        self.assertIn("%SRCROOT%", self.run["originalUriBaseIds"])
+        self.assertEqual(self.run["properties"]["totalFiles"], 2)
+        self.assertEqual(self.run["properties"]["totalResults"], len(self.run["results"]))
+        self.assertTrue(self.run["results"])
+        for result in self.run["results"]:
+            self.assertEqual(driver["rules"][result["ruleIndex"]]["id"], result["ruleId"])
+            self.assertIn(result["level"], ("error", "warning", "note"))
+            location = result["locations"][0]["physicalLocation"]
+            self.assertEqual(location["artifactLocation"]["uriBaseId"], "%SRCROOT%")
+            self.assertIn(location["artifactLocation"]["uri"], ("src/clean.c", "src/bad.c"))
+            self.assertGreater(location["region"]["startLine"], 0)
+
+    def test_messages_leave_out_the_guidance(self):
+        rules = self.run["tool"]["driver"]["rules"]
+        for result in self.run["results"]:
+            guidance = rules[result["ruleIndex"]].get("fullDescription", {}).get("text")
+            self.assertTrue(result["message"]["text"])
+            if guidance:
+                self.assertNotIn(guidance, result["message"]["text"])
+
+
+if __name__ == "__main__":
+    unittest.main()
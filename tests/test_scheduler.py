@@ -0,0 +1,50 @@
+import multiprocessing
+import os
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, temp_dir, write_tree
+
+from complyc.jobserver import Jobserver
+from complyc.loader import load_rules
+from complyc.scheduler import RunStats, TimingStore, run_scheduled
+
+
+class JobserverWorkersTest(unittest.TestCase):
+    def setUp(self):
+        files = {f"f{i}.c": (BAD_C if i % 2 else CLEAN_C) for i in range(8)}
+        self.paths = write_tree(temp_dir(self), files)
+        _, self.rules = load_rules(RULES)
+
+    def jobserver(self, free_tokens):
+        r, w = os.pipe()
+        os.set_blocking(r, False)
+        os.write(w, b"+" * free_tokens)
+        js = Jobserver(r, w, "test pipe")
+        self.addCleanup(os.close, w)
+        self.addCleanup(js.close)
+        return js
+
+    def run_with(self, jobserver):
+        stats = RunStats()
+        most = 0
+        results = run_scheduled(self.paths, self.rules, False, 4, False, TimingStore(None), stats, jobserver)
+        for index, path, payload, error in results:
+            self.assertIsNone(error)
+            most = max(most, len(multiprocessing.active_children()))
+        return stats, most
+
+    def test_no_token_spawns_only_the_implicit_worker(self):
+        stats, most = self.run_with(self.jobserver(0))
+        self.assertEqual(most, 1)
+        self.assertEqual(stats.jobserver_peak, 1)
+
+    def test_peak_counts_the_implicit_slot(self):
+        js = self.jobserver(1)
+        stats, most = self.run_with(js)
+        self.assertLessEqual(most, 2)
+        self.assertEqual(stats.jobserver_peak, js.peak + 1)
+        self.assertEqual(stats.jobserver_peak, js.peak_jobs)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,50 @@
+import copy
+import os
+import unittest
+
+from support import BAD_C, RULES, temp_dir, write_tree
+
+from complyc import runner
+from complyc.loader import load_rules
+from complyc.runner import ResultMemo
+from complyc.server import AnalysisService, _probe_run
+
+
+class ResultMemoTest(unittest.TestCase):
+    def test_reloaded_rules_hit_without_pinning_them(self):
+        path, = write_tree(temp_dir(self), {"a.c": BAD_C})
+        _, rules = load_rules(RULES)
+        memo = ResultMemo()
+        first = memo.analyze(path, rules, False, None)
+        for _ in range(3):
+            self.assertEqual(memo.analyze(path, copy.deepcopy(rules), False, None), first)
+        self.assertEqual((memo.hits, memo.misses), (3, 1))
+        self.assertEqual(len(memo.entries), 1)
+
+
+class DaemonJobsTest(unittest.TestCase):
+    def test_probe_run(self):
+        self.assertEqual(_probe_run(["a.c"]).jobs, 1)
+        self.assertEqual(_probe_run(["-j", "4", "a.c"]).jobs, 4)
+        self.assertEqual(_probe_run(["--jobs=0", "a.c"]).jobs, 0)
+        self.assertEqual(_probe_run(["-j", "x"]).jobs, 1)
+        self.assertFalse(_probe_run(["a.c"]).watch)
+        self.assertTrue(_probe_run(["--watch", "a.c"]).watch)
+
+    def test_parallel_requests_are_rejected(self):
+        self.addCleanup(setattr, runner, "_memo", None)
+        result = AnalysisService().run({"argv": ["-j", "2", "--rules", RULES, "a.c"], "cwd": os.getcwd()})
+        self.assertEqual(result["exit_code"], 2)
+        self.assertIn("-j is not supported by the daemon", result["stderr"])
+
+    def test_watch_requests_are_rejected(self):
+        self.addCleanup(setattr, runner, "_memo", None)
+        service = AnalysisService()
+        result = service.run({"argv": ["--watch", "--rules", RULES, "a.c"], "cwd": os.getcwd()})
+        self.assertEqual(result["exit_code"], 2)
+        self.assertIn("--watch is not supported by the daemon", result["stderr"])
+        self.assertFalse(service.lock.locked())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,59 @@
+import json
+import os
+import unittest
+from types import SimpleNamespace
+
+from support import CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+from complyc.merge import check_shards
+from complyc.shard import assign_shards
+
+
+class ShardTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        self.files = {f"src/f{i}.c": CLEAN_C + "/* pad */\n" * i for i in range(12)}
+        write_tree(self.root, self.files)
+
+    def shard_block(self, cache_dir, index):
+        report = os.path.join(self.root, f"shard{index}.json")
+        result = run_cli(
+            ["--no-gcc", "--rules", RULES, "--cache-dir", cache_dir, "--shard", f"{index}/3",
+             "--json-report", report, "src"],
+            cwd=self.root,
+        )
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        with open(report, encoding="utf-8") as f:
+            return json.load(f)["shard"]
+
+    def test_partition_is_disjoint_and_complete(self):
+        paths = sorted(self.files)
+        shards = assign_shards([os.path.join(self.root, p) for p in paths], 3)
+        self.assertEqual(set(shards), {0, 1, 2})
+        self.assertEqual(shards, assign_shards([os.path.join(self.root, p) for p in paths], 3))
+
+    def test_local_timing_history_does_not_change_the_partition(self):
+        clean_cache = os.path.join(self.root, "cache-a")
+        skewed_cache = os.path.join(self.root, "cache-b")
+        # A history that makes the smallest file look by far the most expensive
+        os.makedirs(skewed_cache)
+        with open(os.path.join(skewed_cache, "timings.json"), "w") as f:
+            json.dump({os.path.join("src", "f0.c"): {"seconds": 100.0, "size": 1}}, f)
+
+        blocks = [self.shard_block(clean_cache, i) for i in (1, 2, 3)]
+        self.assertEqual(sorted(p for b in blocks for p in b["positions"]), list(range(12)))
+        self.assertEqual(len({b["partition"] for b in blocks}), 1)
+        for i in (1, 2, 3):
+            self.assertEqual(self.shard_block(skewed_cache, i), blocks[i - 1])
+
+
+class CheckShardsTest(unittest.TestCase):
+    def test_different_partitions_point_at_file_lists_or_sizes(self):
+        readers = [SimpleNamespace(path=f"s{i}.json", header={"shard": {"index": i, "count": 2, "partition": f"p{i}"}})
+                   for i in (1, 2)]
+        problems = check_shards(readers)
+        self.assertEqual(problems, ["shard reports were partitioned differently (different file lists or file sizes)"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,30 @@
+import os
+import unittest
+
+from support import BAD_C, CLEAN_C, RULES, run_cli, temp_dir, write_tree
+
+
+class TimingPersistenceTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        self.sources = write_tree(self.root, {"a.c": CLEAN_C, "b.c": BAD_C})
+        self.cache = os.path.join(self.root, "cache")
+        self.timings = os.path.join(self.cache, "timings.json")
+
+    def run_complyc(self, *extra):
+        result = run_cli(["--no-gcc", "--no-reports", "--rules", RULES, "--cache-dir", self.cache, *extra, *self.sources],
+                         cwd=self.root)
+        self.assertIn(result.returncode, (0, 1), result.stderr)
+        return result
+
+    def test_plain_run_writes_no_timings(self):
+        self.run_complyc()
+        self.assertFalse(os.path.exists(self.timings))
+
+    def test_parallel_run_records_timings(self):
+        self.run_complyc("-j", "2")
+        self.assertTrue(os.path.exists(self.timings))
+
+
+if __name__ == "__main__":
+    unittest.main()
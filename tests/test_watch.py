@@ -0,0 +1,82 @@
+import os
+import sys
+import unittest
+from contextlib import redirect_stdout
+from io import StringIO
+
+from support import BAD_C, CLEAN_C, RULES, temp_dir, write_tree
+
+from complyc.discovery import norm_path
+from complyc.loader import load_rules
+from complyc.watch import InotifyWatcher, WatchSession, _walk_dirs
+
+
+class WatchIgnoreTest(unittest.TestCase):
+    def setUp(self):
+        self.root = temp_dir(self)
+        write_tree(self.root, {
+            ".gitignore": "build/\n",
+            "src/main.c": CLEAN_C,
+            "build/out.c": BAD_C,
+            "gen/tables.c": BAD_C,
+        })
+        _, rules = load_rules(RULES)
+        self.session = WatchSession([self.root], rules, use_gcc=False, excludes=["gen/"])
+        with redirect_stdout(StringIO()):
+            self.session.initial_scan()
+
+    def path(self, rel):
+        return os.path.join(self.root, rel)
+
+    def test_initial_scan_skips_ignored_and_excluded(self):
+        self.assertEqual(set(self.session.results), {norm_path(self.path("src/main.c"))})
+
+    def test_ignored_changes_are_dropped(self):
+        for rel in ("build/out.c", "gen/tables.c", "build/new/deep.c"):
+            with redirect_stdout(StringIO()):
+                self.assertEqual(self.session.apply_changes([self.path(rel)]), 0, rel)
+        with redirect_stdout(StringIO()):
+            self.assertEqual(self.session.apply_changes([self.path("src/main.c")]), 1)
+
+    def test_ignored_directories_are_not_watched(self):
+        watched = set(_walk_dirs([self.root], self.session.skip_dir))
+        self.assertEqual(watched, {self.root, self.path("src")})
+
+    def test_gitignore_change_drops_now_ignored_results(self):
+        with open(self.path(".gitignore"), "a") as f:
+            f.write("src/\n")
+        with redirect_stdout(StringIO()):
+            self.session.apply_changes([self.path(".gitignore")])
+        self.assertEqual(self.session.results, {})
+
+
+class WatchMovedDirectoryTest(unittest.TestCase):
+    def setUp(self):
+        base = temp_dir(self)
+        self.root = os.path.join(base, "tree")
+        self.outside = os.path.join(base, "elsewhere")
+        write_tree(self.root, {"main.c": CLEAN_C, "sub/a.c": BAD_C, "sub/deep/b.c": BAD_C})
+        _, rules = load_rules(RULES)
+        self.session = WatchSession([self.root], rules, use_gcc=False)
+        with redirect_stdout(StringIO()):
+            self.session.initial_scan()
+
+    def test_results_below_a_moved_away_directory_are_dropped(self):
+        os.rename(os.path.join(self.root, "sub"), self.outside)
+        out = StringIO()
+        with redirect_stdout(out):
+            self.session.apply_changes([os.path.join(self.root, "sub") + os.sep])
+        self.assertEqual(set(self.session.results), {norm_path(os.path.join(self.root, "main.c"))})
+        self.assertIn("- ", out.getvalue())
+
+    @unittest.skipUnless(sys.platform.startswith("linux"), "needs inotify")
+    def test_inotify_reports_the_moved_directory_and_forgets_it(self):
+        watcher = InotifyWatcher([self.root])
+        self.addCleanup(watcher.close)
+        os.rename(os.path.join(self.root, "sub"), self.outside)
+        self.assertIn(os.path.join(self.root, "sub") + os.sep, watcher.wait())
+        self.assertEqual(set(watcher._dirs.values()), {self.root})
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,106 @@
+"""
+bench_startup.py – Start-up latency benchmark for single-file runs
+
+Times complete `complyc.main` invocations on one small file, the way a
+pre-commit hook runs it (--quiet --no-reports, builtin preprocessor):
+
+    cold : fresh cache dir every run (rule bundle and timings rebuilt)
+    warm : cache dir primed by a previous run
+
+A bare `python -c pass` is measured as the floor. With --zipapp the same is
+measured for a built .pyz. --record appends the results as one JSON line to a
+history file, to track start-up time across changes.
+
+Usage:
+    python tools/bench_startup.py [--runs 15] [--zipapp dist/complyc.pyz] [--record bench/startup.ndjson]
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def _time_command(cmd, runs: int, make_cache_dir) -> list:
+    samples = []
+    for _ in range(runs):
+        with tempfile.TemporaryDirectory(prefix="complyc-bench-") as fresh:
+            cache_dir = make_cache_dir(fresh)
+            full = [c.replace("{cache}", cache_dir) for c in cmd]
+            t0 = time.perf_counter()
+            subprocess.run(full, cwd=REPO_ROOT, stdout=subprocess.DEVNULL, check=True)
+            samples.append((time.perf_counter() - t0) * 1000)
+    return samples
+
+
+def _stats(samples) -> dict:
+    return {
+        "min_ms": round(min(samples), 1),
+        "median_ms": round(statistics.median(samples), 1),
+        "max_ms": round(max(samples), 1),
+    }
+
+
+def bench(launcher, rules: str, source: str, runs: int) -> dict:
+    cmd = launcher + ["--rules", rules, "--no-gcc", "--quiet", "--no-reports", "--cache-dir", "{cache}", source]
+
+    cold = _time_command(cmd, runs, lambda fresh: fresh)
+
+    warm_dir = tempfile.mkdtemp(prefix="complyc-bench-warm-")
+    try:
+        # Prime once: rule bundle + timings
+        subprocess.run([c.replace("{cache}", warm_dir) for c in cmd], cwd=REPO_ROOT,
+                       stdout=subprocess.DEVNULL, check=True)
+        warm = _time_command(cmd, runs, lambda fresh: warm_dir)
+    finally:
+        shutil.rmtree(warm_dir, ignore_errors=True)
+
+    return {"cold": _stats(cold), "warm": _stats(warm)}
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Benchmark ComplyC start-up latency")
+    parser.add_argument("--runs", type=int, default=15)
+    parser.add_argument("--rules", default=os.path.join("rules", "complyc_style.yml"))
+    parser.add_argument("--file", default=os.path.join("examples", "sample_good.c"))
+    parser.add_argument("--zipapp", help="Also benchmark this .pyz (see tools/build_zipapp.py)")
+    parser.add_argument("--record", help="Append the results as a JSON line to this file")
+    args = parser.parse_args(argv)
+
+    floor = _time_command([sys.executable, "-c", "pass"], args.runs, lambda fresh: fresh)
+    results = {
+        "timestamp": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "python": sys.version.split()[0],
+        "runs": args.runs,
+        "interpreter": _stats(floor),
+        "module": bench([sys.executable, "-m", "complyc.main"], args.rules, args.file, args.runs),
+    }
+    if args.zipapp:
+        results["zipapp"] = bench([sys.executable, os.path.abspath(args.zipapp)],
+                                  args.rules, args.file, args.runs)
+
+    print(f"python -c pass          : {results['interpreter']['median_ms']:7.1f} ms (median)")
+    for name in ("module", "zipapp"):
+        if name in results:
+            for mode in ("cold", "warm"):
+                s = results[name][mode]
+                print(f"{name:7} {mode:4}            : {s['median_ms']:7.1f} ms "
+                      f"(min {s['min_ms']:.1f}, max {s['max_ms']:.1f})")
+
+    if args.record:
+        os.makedirs(os.path.dirname(os.path.abspath(args.record)), exist_ok=True)
+        with open(args.record, "a", encoding="utf-8") as f:
+            f.write(json.dumps(results) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+"""
+build_zipapp.py – Package ComplyC as a single-file zipapp
+
+Bundles the complyc package (and, unless --no-vendor is given, its pure-Python
+dependencies pycparser and yaml) into one executable .pyz with precompiled
+bytecode next to every module. zipimport cannot write __pycache__ files, so
+without the bytecode every run would recompile all sources.
+
+The .pyc files are hash-based and unchecked (zip timestamps are too coarse
+for mtime checks) and are only used by the Python version that built them;
+other versions fall back to the bundled sources.
+
+Usage:
+    python tools/build_zipapp.py [-o dist/complyc.pyz] [--no-vendor]
+    ./dist/complyc.pyz --rules rules/complyc_style.yml src/foo.c
+"""
+
+from __future__ import annotations
+
+import argparse
+import compileall
+import importlib.util
+import os
+import py_compile
+import shutil
+import sys
+import tempfile
+import zipapp
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+VENDORED = ("pycparser", "yaml")
+
+MAIN = """\
+import sys
+
+from complyc.main import main
+
+sys.exit(main())
+"""
+
+
+def _copy_package(src_dir: str, dest_dir: str):
+    """Copy the .py files of a package tree (no caches, no extension modules)."""
+    for dirpath, dirnames, filenames in os.walk(src_dir):
+        dirnames[:] = [d for d in dirnames if d != "__pycache__"]
+        rel = os.path.relpath(dirpath, src_dir)
+        target = os.path.normpath(os.path.join(dest_dir, rel))
+        os.makedirs(target, exist_ok=True)
+        for name in filenames:
+            if name.endswith(".py"):
+                shutil.copy2(os.path.join(dirpath, name), os.path.join(target, name))
+
+
+def build(output: str, vendor: bool = True) -> str:
+    with tempfile.TemporaryDirectory(prefix="complyc-zipapp-") as staging:
+        _copy_package(os.path.join(REPO_ROOT, "complyc"), os.path.join(staging, "complyc"))
+        if vendor:
+            for name in VENDORED:
+                spec = importlib.util.find_spec(name)
+                if spec is None or not spec.submodule_search_locations:
+                    raise SystemExit(f"[ComplyC] Cannot vendor {name}: not installed")
+                _copy_package(list(spec.submodule_search_locations)[0], os.path.join(staging, name))
+
+        with open(os.path.join(staging, "__main__.py"), "w", encoding="utf-8") as f:
+            f.write(MAIN)
+
+        ok = compileall.compile_dir(
+            staging,
+            quiet=1,
+            legacy=True,
+            invalidation_mode=py_compile.PycInvalidationMode.UNCHECKED_HASH,
+        )
+        if not ok:
+            raise SystemExit("[ComplyC] Byte-compilation failed")
+
+        os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+        # Stored, not deflated: decompression would cost start-up time
+        zipapp.create_archive(staging, output, interpreter="/usr/bin/env python3")
+    return output
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Build a single-file ComplyC zipapp")
+    parser.add_argument("-o", "--output", default=os.path.join("dist", "complyc.pyz"))
+    parser.add_argument(
+        "--no-vendor",
+        action="store_true",
+        help="Do not bundle pycparser/yaml (they must then be installed)",
+    )
+    args = parser.parse_args(argv)
+    path = build(args.output, vendor=not args.no_vendor)
+    size_kb = os.path.getsize(path) / 1024
+    print(f"[ComplyC] Built {path} ({size_kb:.0f} KiB, Python {sys.version_info[0]}.{sys.version_info[1]} bytecode)")
+
+
+if __name__ == "__main__":
+    main()